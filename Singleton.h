@@ -30,6 +30,15 @@ private:
     classname&operator=(const classname&)= delete; \
     classname()= default;    \
     ~classname()=default;
+
+// 与SINGLETON相同,但析构函数由类自行定义,用于析构时需要释放线程等资源的单例
+#define SINGLETON_WITH_DESTRUCTOR(classname) \
+    friend class cxk::Singleton<classname>; \
+    private:                \
+    classname(const classname&)= delete; \
+    classname&operator=(const classname&)= delete; \
+    classname()= default;    \
+    ~classname();
 }
 
 
@@ -0,0 +1,232 @@
+//
+// Created by cxk_zjq on 25-6-3.
+//
+
+#ifndef STEADYTIMER_BENCHUTIL_H
+#define STEADYTIMER_BENCHUTIL_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "clock.h"
+#include "WaitStrategy.h"
+
+namespace cxk::bench
+{
+
+/**
+ * @brief 延迟样本的分位数统计(单位与样本一致)
+ */
+struct LatencySummary
+{
+    std::size_t count = 0;
+    int64_t p50 = 0;
+    int64_t p99 = 0;
+    int64_t p999 = 0;
+    int64_t max = 0;
+};
+
+// 对已排序样本取分位数,p取值[0,1]
+inline int64_t Percentile(const std::vector<int64_t> &sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+// 会对样本原地排序
+inline LatencySummary Summarize(std::vector<int64_t> &samples)
+{
+    LatencySummary summary;
+    std::sort(samples.begin(), samples.end());
+    summary.count = samples.size();
+    summary.p50 = Percentile(samples, 0.5);
+    summary.p99 = Percentile(samples, 0.99);
+    summary.p999 = Percentile(samples, 0.999);
+    summary.max = samples.empty() ? 0 : samples.back();
+    return summary;
+}
+
+/**
+ * @brief 固定大小的对数分桶直方图,内存占用与样本个数无关
+ *
+ * 小于16的值精确计数,之后每个2的幂区间再均分为16个子桶,分位数的相对误差不超过1/16。
+ * 计数为原子变量,可由多个线程并发Record;max精确记录。
+ */
+class LatencyHistogram
+{
+public:
+    void Record(int64_t value)
+    {
+        value = std::max<int64_t>(0, value);
+        m_buckets[BucketOf(static_cast<uint64_t>(value))].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        int64_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    std::size_t Count() const { return m_count.load(std::memory_order_relaxed); }
+
+    // 分位数取所在桶的上界(不超过max),偏保守
+    LatencySummary Summarize() const
+    {
+        LatencySummary summary;
+        summary.count = Count();
+        summary.max = m_max.load(std::memory_order_relaxed);
+        summary.p50 = Percentile(0.5, summary);
+        summary.p99 = Percentile(0.99, summary);
+        summary.p999 = Percentile(0.999, summary);
+        return summary;
+    }
+
+private:
+    static constexpr std::size_t kSubBits = 4;
+    static constexpr std::size_t kSub = std::size_t(1) << kSubBits;
+    static constexpr std::size_t kBuckets = kSub + (64 - kSubBits) * kSub;
+
+    static std::size_t BucketOf(uint64_t value)
+    {
+        if (value < kSub)
+        {
+            return static_cast<std::size_t>(value);
+        }
+        std::size_t exp = 63 - static_cast<std::size_t>(__builtin_clzll(value)); // >= kSubBits
+        std::size_t sub = static_cast<std::size_t>(value >> (exp - kSubBits)) & (kSub - 1);
+        return kSub + (exp - kSubBits) * kSub + sub;
+    }
+
+    static int64_t UpperBoundOf(std::size_t bucket)
+    {
+        if (bucket < kSub)
+        {
+            return static_cast<int64_t>(bucket);
+        }
+        std::size_t exp = (bucket - kSub) / kSub + kSubBits;
+        uint64_t sub = (bucket - kSub) % kSub;
+        uint64_t width = uint64_t(1) << (exp - kSubBits);
+        return static_cast<int64_t>(((kSub + sub) << (exp - kSubBits)) + width - 1);
+    }
+
+    int64_t Percentile(double p, const LatencySummary &summary) const
+    {
+        if (summary.count == 0)
+        {
+            return 0;
+        }
+        auto rank = static_cast<std::size_t>(p * static_cast<double>(summary.count - 1) + 0.5) + 1;
+        std::size_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i)
+        {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                return std::min(UpperBoundOf(i), summary.max);
+            }
+        }
+        return summary.max;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> m_buckets{};
+    std::atomic<std::size_t> m_count{0};
+    std::atomic<int64_t> m_max{0};
+};
+
+// FastSteadyClock当前时间(ns)
+inline int64_t NowNs()
+{
+    return FastSteadyClock::now().time_since_epoch().count();
+}
+
+// 当前线程消耗的CPU时间(ns)
+inline int64_t ThreadCpuNs()
+{
+    struct timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// 整个进程消耗的CPU时间(ns)
+inline int64_t ProcessCpuNs()
+{
+    struct timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// CLOCK_MONOTONIC当前时间(ns),作为FastSteadyClock漂移的参照
+inline int64_t MonotonicNs()
+{
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// 忙等us微秒,模拟回调耗时
+inline void SpinFor(std::size_t us)
+{
+    if (us == 0)
+    {
+        return;
+    }
+    int64_t end = NowNs() + static_cast<int64_t>(us) * 1000;
+    while (NowNs() < end)
+    {
+        CpuRelax();
+    }
+}
+
+// 启动FastSteadyClock的校准线程并等待首次校准完成
+inline void StartClockCalibration()
+{
+    std::thread calibThread(&FastSteadyClock::ThreadRun);
+    calibThread.detach();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+/**
+ * @brief 记录唤醒延迟的定时器回调,各测量工具共用同一延迟定义
+ *
+ * 第k次触发(k从0开始)的理想时间为firstDeadlineNs + k*intervalNs,延迟(us)为实际时间与之差,提前触发记为0。
+ * 记录后忙等costUs模拟回调耗时,再递减remaining。
+ */
+class LatenessRecorder
+{
+public:
+    LatenessRecorder(LatencyHistogram &histogram, std::atomic<std::size_t> &remaining, int64_t firstDeadlineNs,
+                     int64_t intervalNs, std::size_t costUs)
+    : m_histogram(&histogram), m_remaining(&remaining), m_firstDeadlineNs(firstDeadlineNs),
+      m_intervalNs(intervalNs), m_costUs(costUs), m_fires(std::make_shared<int64_t>(0))
+    {
+    }
+
+    void operator()()
+    {
+        int64_t deadlineNs = m_firstDeadlineNs + (*m_fires)++ * m_intervalNs;
+        m_histogram->Record((NowNs() - deadlineNs) / 1000);
+        SpinFor(m_costUs);
+        m_remaining->fetch_sub(1);
+    }
+
+private:
+    LatencyHistogram *m_histogram;
+    std::atomic<std::size_t> *m_remaining;
+    int64_t m_firstDeadlineNs;
+    int64_t m_intervalNs;
+    std::size_t m_costUs;
+    std::shared_ptr<int64_t> m_fires; // 回调对象可能被复制,触发次数放在共享计数里
+};
+
+} // cxk::bench
+
+#endif //STEADYTIMER_BENCHUTIL_H
@@ -0,0 +1,77 @@
+//
+// Created by cxk_zjq on 25-6-12.
+//
+// 同一轮大量定时器同时到期时,统计辅助线程个数对突发尾部延迟的影响
+// 每个样本为定时器回调完成时刻相对本轮Update开始的时间,max即整轮突发处理完的时间
+// 用法: bench_burst [定时器个数=20000] [回调耗时us=20] [busy|sleep] [分组数=0]
+// busy在回调内空转,只有多核时才能看到扩展;sleep模拟阻塞型回调,单核也能体现并行效果
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "TimeLineTimer.h"
+#include "bench/BenchUtil.h"
+
+using namespace cxk;
+using SimTimerManager = BasicTimerManager<VirtualClock>;
+
+namespace
+{
+
+void RunBurst(std::size_t helpers, std::size_t timerCount, std::size_t costUs, bool sleep, std::size_t groups)
+{
+    auto &manager = Singleton<SimTimerManager>::GetInstance();
+    manager.Clear();
+    manager.SetBurstOptions(helpers > 0 ? 64 : static_cast<std::size_t>(-1), helpers);
+
+    std::vector<int64_t> doneNs(timerCount);
+    int64_t t0 = 0;
+    for (std::size_t i = 0; i < timerCount; ++i)
+    {
+        std::size_t group = groups > 0 ? i % groups + 1 : 0;
+        manager.AddTimer(1000, [&doneNs, &t0, i, costUs, sleep]() {
+            if (sleep)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(costUs));
+            }
+            else
+            {
+                bench::SpinFor(costUs);
+            }
+            doneNs[i] = bench::NowNs() - t0; // 每个定时器只写自己的槽位
+        }, 1, TimerPriority::Normal, group);
+    }
+
+    // 新加入的定时器在下一轮Update立即到期,全部落在同一轮
+    t0 = bench::NowNs();
+    std::size_t fired = manager.Update();
+    int64_t total = bench::NowNs() - t0;
+    auto s = bench::Summarize(doneNs);
+    std::printf("%-8zu %-8zu %10.2f %10.2f %10.2f %10.2f\n", helpers, fired, static_cast<double>(s.p50) / 1e6,
+                static_cast<double>(s.p99) / 1e6, static_cast<double>(s.max) / 1e6, static_cast<double>(total) / 1e6);
+    manager.SetBurstOptions(-1, 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::size_t timerCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    std::size_t costUs = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    bool sleep = argc > 3 && std::strcmp(argv[3], "sleep") == 0;
+    std::size_t groups = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+    std::printf("timers=%zu cost=%zuus %s groups=%zu hw_threads=%u\n", timerCount, costUs, sleep ? "sleep" : "busy",
+                groups, std::thread::hardware_concurrency());
+    std::printf("%-8s %-8s %10s %10s %10s %10s\n", "helpers", "fired", "p50(ms)", "p99(ms)", "max(ms)", "update(ms)");
+
+    VirtualClock::Reset();
+    for (std::size_t helpers : {0, 1, 2, 4, 8})
+    {
+        RunBurst(helpers, timerCount, costUs, sleep, groups);
+    }
+    return 0;
+}
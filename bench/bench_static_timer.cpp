@@ -0,0 +1,135 @@
+//
+// Created by cxk_zjq on 25-6-6.
+//
+// 对比类型擦除的BasicTimerManager与编译期特化的BasicStaticTimerManager
+// 两者都使用VirtualClock逐毫秒推进,只统计定时器调度与回调分派本身的开销
+// static <std::function>与static <Hit>使用同一个时间轮,两者之差才是分派方式本身的开销,
+// 与type-erased TimerManager之差还包含了multimap与时间轮的差别
+// 用法: bench_static_timer [定时器个数=100000] [逻辑时间ms=10000]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+#include "StaticTimerManager.h"
+#include "TimeLineTimer.h"
+#include "bench/BenchUtil.h"
+
+using namespace cxk;
+
+namespace
+{
+
+struct Hit
+{
+    std::size_t *counter;
+    void operator()() { ++*counter; }
+};
+
+struct WeightedHit
+{
+    std::size_t *counter;
+    std::size_t weight;
+    void operator()() { *counter += weight; }
+};
+
+struct Workload
+{
+    std::vector<std::size_t> intervals;
+    std::vector<std::size_t> repeats;
+};
+
+Workload MakeWorkload(std::size_t timerCount, std::size_t durationMs)
+{
+    Workload w;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<std::size_t> intervalDist(1, 1000);
+    for (std::size_t i = 0; i < timerCount; ++i)
+    {
+        std::size_t interval = intervalDist(rng);
+        w.intervals.push_back(interval);
+        w.repeats.push_back(durationMs / interval + 1);
+    }
+    return w;
+}
+
+void Report(const char *name, std::size_t fires, int64_t ns)
+{
+    std::printf("%-28s fires=%-10zu total=%8.1fms  %6.1f ns/fire  %6.2f Mfires/s\n", name, fires,
+                static_cast<double>(ns) / 1e6, static_cast<double>(ns) / static_cast<double>(fires),
+                static_cast<double>(fires) * 1e3 / static_cast<double>(ns));
+}
+
+template<class AddFn, class UpdateFn>
+void Run(const char *name, const Workload &w, std::size_t durationMs, AddFn add, UpdateFn update)
+{
+    std::size_t counter = 0;
+    int64_t begin = bench::NowNs();
+    for (std::size_t i = 0; i < w.intervals.size(); ++i)
+    {
+        add(i, counter);
+    }
+    std::size_t fires = 0;
+    for (std::size_t t = 0; t <= durationMs; ++t)
+    {
+        fires += update();
+        VirtualClock::Advance(std::chrono::milliseconds(1));
+    }
+    Report(name, fires, bench::NowNs() - begin);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::size_t timerCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::size_t durationMs = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    Workload w = MakeWorkload(timerCount, durationMs);
+    std::printf("timers=%zu duration=%zums\n", timerCount, durationMs);
+
+    // 每个管理器都从逻辑时间0开始
+    VirtualClock::Reset();
+    auto &erased = Singleton<BasicTimerManager<VirtualClock>>::GetInstance();
+    Run("type-erased TimerManager", w, durationMs,
+        [&](std::size_t i, std::size_t &counter) {
+            erased.AddTimer(w.intervals[i], Hit{&counter}, w.repeats[i]);
+        },
+        [&]() { return erased.Update(); });
+    erased.Clear();
+
+    VirtualClock::Reset();
+    BasicStaticTimerManager<VirtualClock, WheelGeometry<1024, 1>, Hit> single;
+    Run("static <Hit>", w, durationMs,
+        [&](std::size_t i, std::size_t &counter) {
+            single.AddTimer(w.intervals[i], Hit{&counter}, w.repeats[i]);
+        },
+        [&]() { return single.Update(); });
+
+    // 同样的时间轮,回调换成std::function,与上一行相比只差分派方式
+    VirtualClock::Reset();
+    BasicStaticTimerManager<VirtualClock, WheelGeometry<1024, 1>, std::function<void()>> erasedWheel;
+    Run("static <std::function>", w, durationMs,
+        [&](std::size_t i, std::size_t &counter) {
+            erasedWheel.AddTimer(w.intervals[i], std::function<void()>(Hit{&counter}), w.repeats[i]);
+        },
+        [&]() { return erasedWheel.Update(); });
+
+    VirtualClock::Reset();
+    BasicStaticTimerManager<VirtualClock, WheelGeometry<1024, 1>, Hit, WeightedHit> variant;
+    Run("static <Hit, WeightedHit>", w, durationMs,
+        [&](std::size_t i, std::size_t &counter) {
+            if (i % 2 == 0)
+            {
+                variant.AddTimer(w.intervals[i], Hit{&counter}, w.repeats[i]);
+            }
+            else
+            {
+                variant.AddTimer(w.intervals[i], WeightedHit{&counter, 2}, w.repeats[i]);
+            }
+        },
+        [&]() { return variant.Update(); });
+    return 0;
+}
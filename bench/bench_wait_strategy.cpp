@@ -0,0 +1,98 @@
+//
+// Created by cxk_zjq on 25-6-3.
+//
+// 对比不同驱动等待策略的CPU占用与唤醒延迟
+// 用法: bench_wait_strategy [定时器个数=1000] [每种策略运行秒数=2] [绑定CPU=-1]
+//
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "TimeLineTimer.h"
+#include "bench/BenchUtil.h"
+
+using namespace cxk;
+
+namespace
+{
+
+struct Result
+{
+    WaitStrategy strategy;
+    double cpuPercent;
+    bench::LatencySummary lateness; // us
+};
+
+Result RunOnce(WaitStrategy strategy, std::size_t timerCount, std::size_t seconds, int cpu)
+{
+    static const std::size_t intervals[] = {1, 5, 10, 50}; // ms
+    TimerManager &manager = Singleton<TimerManager>::GetInstance();
+
+    DriverOptions options;
+    options.strategy = strategy;
+    options.cpu = cpu;
+    options.threadName = std::string("drv-") + ToString(strategy);
+    manager.SetDriverOptions(options);
+
+    bench::LatencyHistogram lateness;
+    std::atomic<std::size_t> remaining{0};
+    int64_t driverCpuNs = 0;
+    int64_t wallStart = bench::NowNs();
+    std::thread driver([&]() {
+        manager.Start();
+        driverCpuNs = bench::ThreadCpuNs();
+    });
+
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < timerCount; ++i)
+    {
+        expected += seconds * 1000 / intervals[i % 4];
+    }
+    remaining.store(expected);
+
+    for (std::size_t i = 0; i < timerCount; ++i)
+    {
+        std::size_t interval = intervals[i % 4];
+        std::size_t repeat = seconds * 1000 / interval;
+        auto start = static_cast<int64_t>(TimeLineTimer::GetCurrentTime()) * 1000000;
+        manager.AddTimer(interval, bench::LatenessRecorder(lateness, remaining, start,
+                                                           static_cast<int64_t>(interval) * 1000000, 0),
+                         repeat);
+    }
+
+    while (remaining.load() > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    manager.Stop();
+    driver.join();
+    int64_t wallNs = bench::NowNs() - wallStart;
+
+    return {strategy, 100.0 * static_cast<double>(driverCpuNs) / static_cast<double>(wallNs), lateness.Summarize()};
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::size_t timerCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    std::size_t seconds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+    int cpu = argc > 3 ? std::atoi(argv[3]) : -1;
+
+    bench::StartClockCalibration();
+
+    std::printf("timers=%zu seconds=%zu cpu=%d\n", timerCount, seconds, cpu);
+    std::printf("%-12s %10s %8s %10s %10s %10s %10s\n",
+                "strategy", "fires", "cpu%", "p50(us)", "p99(us)", "p99.9(us)", "max(us)");
+    for (auto strategy : {WaitStrategy::BusySpin, WaitStrategy::SpinYield, WaitStrategy::SpinPark, WaitStrategy::Sleep})
+    {
+        Result r = RunOnce(strategy, timerCount, seconds, cpu);
+        std::printf("%-12s %10zu %8.1f %10lld %10lld %10lld %10lld\n",
+                    ToString(r.strategy), r.lateness.count, r.cpuPercent,
+                    static_cast<long long>(r.lateness.p50), static_cast<long long>(r.lateness.p99),
+                    static_cast<long long>(r.lateness.p999), static_cast<long long>(r.lateness.max));
+    }
+    return 0;
+}
@@ -1,17 +1,425 @@
-#include <iostream>
+//
+// Created by cxk_zjq on 25-6-10.
+//
+// 定时精度测量工具:对TimerManager和MultiThreadTimer施加可配置的负载,
+// 统计唤醒延迟分位数、吞吐、驱动线程CPU时间,以及FastSteadyClock相对CLOCK_MONOTONIC的漂移,
+// 以表格/CSV/JSON输出,便于比较不同内核和主机。
+//
 
-// TIP 要<b>Run</b>代码，请按 <shortcut actionId="Run"/> 或点击装订区域中的 <icon src="AllIcons.Actions.Execute"/> 图标。
-int main()
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/utsname.h>
+#include "MultiThreadTimer.h"
+#include "TimeLineTimer.h"
+#include "bench/BenchUtil.h"
+
+using namespace cxk;
+
+namespace
 {
-    // TIP 当文本光标位于 <b>lang</b> 变量名称处时，按 <shortcut actionId="RenameElement"/> 可以查看 CLion 如何帮助您重命名该变量。
-    auto lang = "C++";
-    std::cout << "Hello and welcome to " << lang << "!\n";
 
-    for (int i = 1; i <= 5; i++) {
-        // TIP 按 <shortcut actionId="Debug"/> 开始调试代码。我们已为您设置了一个 <icon src="AllIcons.Debugger.Db_set_breakpoint"/> 断点，但您可以随时按 <shortcut actionId="ToggleLineBreakpoint"/> 添加更多断点。
-        std::cout << "i = " << i << std::endl;
+struct Options
+{
+    std::string target = "both";               // manager | multi | both
+    std::size_t timers = 1000;                 // 定时器个数
+    std::vector<std::size_t> intervals{1, 10, 100}; // 间隔组合(ms),按定时器序号轮流分配
+    std::size_t producers = 1;                 // 添加定时器的线程数
+    std::size_t costUs = 0;                    // 每次回调的忙等耗时(us)
+    std::size_t seconds = 5;                   // 每个目标的运行时间
+    std::size_t multiLimit = 256;              // MultiThreadTimer每个定时器一个线程,限制个数
+    WaitStrategy strategy = WaitStrategy::BusySpin;
+    int cpu = -1;
+    std::string format = "table";              // table | csv | json
+};
+
+struct Drift
+{
+    std::size_t samples = 0;
+    int64_t maxAbsNs = 0;  // 最大绝对漂移
+    int64_t finalNs = 0;   // 结束时的漂移
+    double ppm = 0;        // 结束时的漂移相对经过时间的比例
+};
+
+struct Result
+{
+    std::string target;
+    std::size_t timers = 0;
+    std::size_t fires = 0;
+    double seconds = 0;
+    double throughput = 0;       // fires/s
+    bench::LatencySummary lateness; // us
+    double cpuMs = 0;
+    std::string cpuScope;        // driver-thread | process
+    Drift drift;
+};
+
+void Usage(const char *argv0)
+{
+    std::printf("usage: %s [options]\n"
+                "  --target=manager|multi|both   timer implementation to measure (default both)\n"
+                "  --timers=N                    number of timers (default 1000)\n"
+                "  --intervals=A,B,...           interval mix in ms (default 1,10,100)\n"
+                "  --producers=N                 threads adding timers (default 1)\n"
+                "  --cost-us=N                   busy work per callback in us (default 0)\n"
+                "  --seconds=N                   run time per target (default 5)\n"
+                "  --multi-limit=N               max MultiThreadTimer instances (default 256)\n"
+                "  --strategy=busy-spin|spin-yield|spin-park|sleep   TimerManager driver wait strategy\n"
+                "  --cpu=N                       pin the TimerManager driver to a CPU\n"
+                "  --format=table|csv|json       output format (default table)\n", argv0);
+}
+
+bool ParseOptions(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--target") options.target = value;
+        else if (key == "--timers") options.timers = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "--producers") options.producers = std::max<std::size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        else if (key == "--cost-us") options.costUs = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "--seconds") options.seconds = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "--multi-limit") options.multiLimit = std::strtoul(value.c_str(), nullptr, 10);
+        else if (key == "--cpu") options.cpu = std::atoi(value.c_str());
+        else if (key == "--format") options.format = value;
+        else if (key == "--intervals")
+        {
+            options.intervals.clear();
+            for (const char *p = value.c_str(); *p != '\0';)
+            {
+                char *end = nullptr;
+                std::size_t interval = std::strtoul(p, &end, 10);
+                if (end == p || interval == 0)
+                {
+                    return false;
+                }
+                options.intervals.push_back(interval);
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        else if (key == "--strategy")
+        {
+            bool found = false;
+            for (auto s : {WaitStrategy::BusySpin, WaitStrategy::SpinYield, WaitStrategy::SpinPark, WaitStrategy::Sleep})
+            {
+                if (value == ToString(s))
+                {
+                    options.strategy = s;
+                    found = true;
+                }
+            }
+            if (!found)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return !options.intervals.empty() && options.seconds > 0 &&
+           (options.target == "manager" || options.target == "multi" || options.target == "both") &&
+           (options.format == "table" || options.format == "csv" || options.format == "json");
+}
+
+/**
+ * @brief 后台定期采样FastSteadyClock与CLOCK_MONOTONIC,统计两者经过时间之差
+ */
+class DriftSampler
+{
+public:
+    void Start()
+    {
+        m_running.store(true);
+        m_thread = std::thread([this]() {
+            int64_t fast0 = bench::NowNs(), mono0 = bench::MonotonicNs();
+            while (m_running.load())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                int64_t fast = bench::NowNs(), mono = bench::MonotonicNs();
+                int64_t drift = (fast - fast0) - (mono - mono0);
+                m_drift.samples++;
+                m_drift.maxAbsNs = std::max<int64_t>(m_drift.maxAbsNs, std::llabs(drift));
+                m_drift.finalNs = drift;
+                m_drift.ppm = mono > mono0 ? static_cast<double>(drift) * 1e6 / static_cast<double>(mono - mono0) : 0;
+            }
+        });
+    }
+
+    Drift Stop()
+    {
+        m_running.store(false);
+        m_thread.join();
+        return m_drift;
     }
 
+private:
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    Drift m_drift;
+};
+
+// 将timers个定时器按序号分给各生产者线程并发添加
+template<class AddFn>
+void Produce(const Options &options, std::size_t timers, AddFn add)
+{
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < options.producers; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (std::size_t i = p; i < timers; i += options.producers)
+            {
+                add(i);
+            }
+        });
+    }
+    for (auto &t : producers)
+    {
+        t.join();
+    }
+}
+
+std::size_t RepeatFor(const Options &options, std::size_t interval)
+{
+    return std::max<std::size_t>(1, options.seconds * 1000 / interval);
+}
+
+Result RunManager(const Options &options)
+{
+    TimerManager &manager = Singleton<TimerManager>::GetInstance();
+    DriverOptions driverOptions;
+    driverOptions.strategy = options.strategy;
+    driverOptions.cpu = options.cpu;
+    driverOptions.threadName = "timer-driver";
+    manager.SetDriverOptions(driverOptions);
+
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < options.timers; ++i)
+    {
+        expected += RepeatFor(options, options.intervals[i % options.intervals.size()]);
+    }
+    bench::LatencyHistogram lateness; // 内存占用与触发次数无关
+    std::atomic<std::size_t> remaining{expected};
+
+    DriftSampler sampler;
+    sampler.Start();
+    int64_t driverCpuNs = 0;
+    int64_t begin = bench::NowNs();
+    std::thread driver([&]() {
+        manager.Start();
+        driverCpuNs = bench::ThreadCpuNs();
+    });
+
+    Produce(options, options.timers, [&](std::size_t i) {
+        std::size_t interval = options.intervals[i % options.intervals.size()];
+        // TimerManager加入时立即触发一次,第k次触发的理想时间为加入时刻(ms)+k*interval
+        auto start = static_cast<int64_t>(TimeLineTimer::GetCurrentTime()) * 1000000;
+        manager.AddTimer(interval, bench::LatenessRecorder(lateness, remaining, start,
+                                                           static_cast<int64_t>(interval) * 1000000, options.costUs),
+                         RepeatFor(options, interval));
+    });
+
+    // 回调过慢时定时器会整体滞后,最多额外等待运行时间的一倍
+    int64_t deadline = begin + static_cast<int64_t>(options.seconds) * 2000000000LL + 1000000000LL;
+    while (remaining.load() > 0 && bench::NowNs() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    manager.Stop();
+    driver.join();
+    manager.Clear(); // 超时返回时仍有定时器引用本函数的局部变量
+    int64_t wallNs = bench::NowNs() - begin;
+
+    Result result;
+    result.target = "manager";
+    result.timers = options.timers;
+    result.fires = lateness.Count();
+    result.seconds = static_cast<double>(wallNs) / 1e9;
+    result.throughput = static_cast<double>(result.fires) / result.seconds;
+    result.lateness = lateness.Summarize();
+    result.cpuMs = static_cast<double>(driverCpuNs) / 1e6;
+    result.cpuScope = "driver-thread";
+    result.drift = sampler.Stop();
+    return result;
+}
+
+Result RunMulti(const Options &options)
+{
+    std::size_t timers = std::min(options.timers, options.multiLimit);
+    std::vector<std::unique_ptr<MultiThreadTimer>> instances;
+    std::vector<MultiThreadTimer::TimerCallback> callbacks(timers);
+    for (std::size_t i = 0; i < timers; ++i)
+    {
+        instances.push_back(std::make_unique<MultiThreadTimer>());
+    }
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i < timers; ++i)
+    {
+        expected += RepeatFor(options, options.intervals[i % options.intervals.size()]);
+    }
+    bench::LatencyHistogram lateness; // 各线程并发记录
+    std::atomic<std::size_t> remaining{expected};
+
+    DriftSampler sampler;
+    sampler.Start();
+    int64_t cpuBegin = bench::ProcessCpuNs();
+    int64_t begin = bench::NowNs();
+    Produce(options, timers, [&](std::size_t i) {
+        int interval = static_cast<int>(options.intervals[i % options.intervals.size()]);
+        // MultiThreadTimer先休眠一个周期再触发,第一次触发的理想时间为启动时刻+interval
+        int64_t intervalNs = interval * 1000000LL;
+        callbacks[i] = bench::LatenessRecorder(lateness, remaining, bench::NowNs() + intervalNs, intervalNs,
+                                               options.costUs);
+        instances[i]->Start(interval, callbacks[i], RepeatFor(options, static_cast<std::size_t>(interval)));
+    });
+    // 与RunManager相同,等待全部重复次数完成,线程过多导致整体滞后时最多额外等待运行时间的一倍
+    int64_t deadline = begin + static_cast<int64_t>(options.seconds) * 2000000000LL + 1000000000LL;
+    while (remaining.load() > 0 && bench::NowNs() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (auto &instance : instances)
+    {
+        instance->Stop(); // 超时未完成的线程在这里被打断
+    }
+    int64_t wallNs = bench::NowNs() - begin;
+    int64_t cpuNs = bench::ProcessCpuNs() - cpuBegin;
+
+    Result result;
+    result.target = "multi";
+    result.timers = timers;
+    result.fires = lateness.Count();
+    result.seconds = static_cast<double>(wallNs) / 1e9;
+    result.throughput = static_cast<double>(result.fires) / result.seconds;
+    result.lateness = lateness.Summarize();
+    result.cpuMs = static_cast<double>(cpuNs) / 1e6;
+    result.cpuScope = "process";
+    result.drift = sampler.Stop();
+    return result;
+}
+
+std::string IntervalList(const Options &options)
+{
+    std::string s;
+    for (auto interval : options.intervals)
+    {
+        s += (s.empty() ? "" : ";") + std::to_string(interval);
+    }
+    return s;
+}
+
+void PrintTable(const Options &options, const std::vector<Result> &results, const utsname &host)
+{
+    std::printf("host=%s kernel=%s strategy=%s producers=%zu cost=%zuus intervals=%sms\n",
+                host.nodename, host.release, ToString(options.strategy), options.producers, options.costUs,
+                IntervalList(options).c_str());
+    std::printf("%-8s %7s %10s %12s %9s %9s %10s %9s %10s %8s %13s %13s %10s\n",
+                "target", "timers", "fires", "fires/s", "p50(us)", "p99(us)", "p99.9(us)", "max(us)",
+                "cpu(ms)", "cpu%", "drift_max(us)", "drift_end(us)", "drift_ppm");
+    for (const auto &r : results)
+    {
+        std::printf("%-8s %7zu %10zu %12.0f %9lld %9lld %10lld %9lld %10.1f %8.1f %13.1f %13.1f %10.2f\n",
+                    r.target.c_str(), r.timers, r.fires, r.throughput,
+                    static_cast<long long>(r.lateness.p50), static_cast<long long>(r.lateness.p99),
+                    static_cast<long long>(r.lateness.p999), static_cast<long long>(r.lateness.max),
+                    r.cpuMs, 100.0 * r.cpuMs / (r.seconds * 1e3),
+                    static_cast<double>(r.drift.maxAbsNs) / 1e3, static_cast<double>(r.drift.finalNs) / 1e3,
+                    r.drift.ppm);
+    }
+    std::printf("cpu: manager = driver thread only, multi = whole process\n");
+}
+
+void PrintCsv(const Options &options, const std::vector<Result> &results, const utsname &host)
+{
+    std::printf("host,kernel,target,strategy,timers,producers,cost_us,intervals_ms,fires,seconds,throughput,"
+                "p50_us,p99_us,p999_us,max_us,cpu_ms,cpu_scope,drift_samples,drift_max_us,drift_end_us,drift_ppm\n");
+    for (const auto &r : results)
+    {
+        std::printf("%s,%s,%s,%s,%zu,%zu,%zu,%s,%zu,%.3f,%.0f,%lld,%lld,%lld,%lld,%.1f,%s,%zu,%.1f,%.1f,%.3f\n",
+                    host.nodename, host.release, r.target.c_str(), ToString(options.strategy), r.timers,
+                    options.producers, options.costUs, IntervalList(options).c_str(), r.fires, r.seconds,
+                    r.throughput, static_cast<long long>(r.lateness.p50), static_cast<long long>(r.lateness.p99),
+                    static_cast<long long>(r.lateness.p999), static_cast<long long>(r.lateness.max), r.cpuMs,
+                    r.cpuScope.c_str(), r.drift.samples, static_cast<double>(r.drift.maxAbsNs) / 1e3,
+                    static_cast<double>(r.drift.finalNs) / 1e3, r.drift.ppm);
+    }
+}
+
+void PrintJson(const Options &options, const std::vector<Result> &results, const utsname &host)
+{
+    std::printf("{\n  \"host\": \"%s\",\n  \"kernel\": \"%s\",\n  \"strategy\": \"%s\",\n"
+                "  \"producers\": %zu,\n  \"cost_us\": %zu,\n  \"intervals_ms\": [",
+                host.nodename, host.release, ToString(options.strategy), options.producers, options.costUs);
+    for (std::size_t i = 0; i < options.intervals.size(); ++i)
+    {
+        std::printf("%s%zu", i == 0 ? "" : ", ", options.intervals[i]);
+    }
+    std::printf("],\n  \"results\": [\n");
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const auto &r = results[i];
+        std::printf("    {\"target\": \"%s\", \"timers\": %zu, \"fires\": %zu, \"seconds\": %.3f, "
+                    "\"throughput\": %.0f,\n     \"lateness_us\": {\"p50\": %lld, \"p99\": %lld, \"p999\": %lld, "
+                    "\"max\": %lld},\n     \"cpu_ms\": %.1f, \"cpu_scope\": \"%s\",\n"
+                    "     \"drift\": {\"samples\": %zu, \"max_us\": %.1f, \"end_us\": %.1f, \"ppm\": %.3f}}%s\n",
+                    r.target.c_str(), r.timers, r.fires, r.seconds, r.throughput,
+                    static_cast<long long>(r.lateness.p50), static_cast<long long>(r.lateness.p99),
+                    static_cast<long long>(r.lateness.p999), static_cast<long long>(r.lateness.max),
+                    r.cpuMs, r.cpuScope.c_str(), r.drift.samples, static_cast<double>(r.drift.maxAbsNs) / 1e3,
+                    static_cast<double>(r.drift.finalNs) / 1e3, r.drift.ppm, i + 1 == results.size() ? "" : ",");
+    }
+    std::printf("  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    // 启动TSC校准线程并等待首次校准完成
+    bench::StartClockCalibration();
+
+    utsname host{};
+    uname(&host);
+
+    std::vector<Result> results;
+    if (options.target != "multi")
+    {
+        results.push_back(RunManager(options));
+    }
+    if (options.target != "manager")
+    {
+        results.push_back(RunMulti(options));
+    }
+
+    if (options.format == "csv")
+    {
+        PrintCsv(options, results, host);
+    }
+    else if (options.format == "json")
+    {
+        PrintJson(options, results, host);
+    }
+    else
+    {
+        PrintTable(options, results, host);
+    }
     return 0;
-    // TIP 请访问 <a href="https://www.jetbrains.com/help/clion/">jetbrains.com/help/clion/</a> 查看 CLion 帮助。此外，您还可以从主菜单中选择“帮助 | 学习 IDE 功能”，尝试 CLion 的交互式课次。
-}
\ No newline at end of file
+}
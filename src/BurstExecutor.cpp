@@ -0,0 +1,103 @@
+//
+// Created by cxk_zjq on 25-6-12.
+//
+
+#include "BurstExecutor.h"
+#include <string>
+#include "WaitStrategy.h"
+
+namespace cxk
+{
+
+BurstExecutor::BurstExecutor(std::size_t helpers)
+: m_errors(helpers + 1)
+{
+    for (std::size_t i = 1; i <= helpers; ++i)
+    {
+        m_threads.emplace_back([this, i]() {
+            HelperLoop(i);
+        });
+    }
+}
+
+BurstExecutor::~BurstExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (auto &t : m_threads)
+    {
+        t.join();
+    }
+}
+
+void BurstExecutor::Run(const std::function<void(std::size_t)> &task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_remaining = m_threads.size();
+        ++m_generation;
+    }
+    m_start.notify_all();
+    try
+    {
+        task(0); // 调用线程同样参与处理,不空等辅助线程
+    }
+    catch (...)
+    {
+        m_errors[0] = std::current_exception(); // 辅助线程仍在引用task,必须等它们结束后才能抛出
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_remaining == 0; });
+    m_task = nullptr;
+    std::exception_ptr first; // 按worker序号取第一个异常,其余丢弃
+    for (auto &error : m_errors)
+    {
+        if (!first)
+        {
+            first = error;
+        }
+        error = nullptr;
+    }
+    lock.unlock();
+    if (first)
+    {
+        std::rethrow_exception(first);
+    }
+}
+
+void BurstExecutor::HelperLoop(std::size_t index)
+{
+    SetCurrentThreadName("timer-burst-" + std::to_string(index));
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_start.wait(lock, [&]() { return m_stop || m_generation != seen; });
+        if (m_stop)
+        {
+            return;
+        }
+        seen = m_generation;
+        const auto *task = m_task;
+        lock.unlock();
+        try
+        {
+            (*task)(index);
+        }
+        catch (...)
+        {
+            m_errors[index] = std::current_exception(); // 在辅助线程上抛出会直接terminate,交给Run重新抛出
+        }
+        lock.lock();
+        if (--m_remaining == 0)
+        {
+            m_done.notify_one();
+        }
+    }
+}
+
+} // cxk
@@ -0,0 +1,54 @@
+//
+// Created by cxk_zjq on 25-6-12.
+//
+
+#ifndef STEADYTIMER_BURSTEXECUTOR_H
+#define STEADYTIMER_BURSTEXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cxk
+{
+
+/**
+ * @brief 处理突发到期的辅助线程组
+ *
+ * Run把同一个任务同时交给所有辅助线程和调用线程执行,task的参数为worker序号
+ * (调用线程为0,辅助线程为1..helpers),全部执行完后返回。Run不可重入,由调用方保证串行。
+ * 某个worker抛出异常时只中止该worker,其余worker照常执行完,之后由Run重新抛出序号最小的worker的异常。
+ */
+class BurstExecutor
+{
+public:
+    explicit BurstExecutor(std::size_t helpers);
+    BurstExecutor(const BurstExecutor &) = delete;
+    BurstExecutor &operator=(const BurstExecutor &) = delete;
+    ~BurstExecutor();
+
+    void Run(const std::function<void(std::size_t)> &task);
+    std::size_t Workers() const { return m_threads.size() + 1; } // 含调用线程
+
+private:
+    void HelperLoop(std::size_t index);
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start; // 通知辅助线程有新任务
+    std::condition_variable m_done;  // 通知调用线程辅助线程都已完成
+    const std::function<void(std::size_t)> *m_task = nullptr;
+    std::uint64_t m_generation = 0; // 每次Run递增,辅助线程据此判断是否有新任务
+    std::size_t m_remaining = 0;    // 尚未完成当前任务的辅助线程数
+    std::vector<std::exception_ptr> m_errors; // 每个worker本次任务抛出的异常
+    bool m_stop = false;
+};
+
+} // cxk
+
+#endif //STEADYTIMER_BURSTEXECUTOR_H
@@ -14,7 +14,7 @@ MultiThreadTimer::MultiThreadTimer() noexcept
 
 MultiThreadTimer::~MultiThreadTimer()
 {
-
+    Stop(); // 线程仍可join时析构std::thread会直接terminate
 }
 
 void MultiThreadTimer::SetRepeatCount(std::size_t count)
@@ -0,0 +1,400 @@
+//
+// Created by cxk_zjq on 25-6-6.
+//
+
+#ifndef STEADYTIMER_STATICTIMERMANAGER_H
+#define STEADYTIMER_STATICTIMERMANAGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "clock.h"
+#include "WaitStrategy.h"
+
+namespace cxk
+{
+
+/**
+ * @brief 时间轮的几何参数,全部为编译期常量
+ * @tparam Slots 槽位数,必须是2的幂,取槽位的取模运算会被折叠为按位与
+ * @tparam TickMs 每个槽位代表的时间(ms),即定时精度
+ */
+template<std::size_t Slots, std::size_t TickMs = 1>
+struct WheelGeometry
+{
+    static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+    static_assert(TickMs > 0, "TickMs must be positive");
+
+    static constexpr std::size_t kSlots = Slots;
+    static constexpr std::size_t kMask = Slots - 1;
+    static constexpr std::size_t kTickMs = TickMs;
+
+    static constexpr std::size_t SlotOf(std::size_t tick) { return tick & kMask; }
+    static constexpr std::size_t ToTick(std::size_t ms) { return ms / TickMs; }
+    // 间隔向上取整到整数个tick,且至少为1个tick,避免零间隔定时器在同一个tick内反复触发
+    static constexpr std::size_t ToTicks(std::size_t intervalMs)
+    {
+        return intervalMs <= TickMs ? 1 : (intervalMs + TickMs - 1) / TickMs;
+    }
+};
+
+/**
+ * @brief 编译期特化的静态类型定时器管理器
+ *
+ * 回调类型在编译期已知,按值保存在std::variant<Callbacks...>中,通过std::visit分派
+ * (编译器生成跳转表,只有一种回调类型时直接内联调用),不经过std::function的类型擦除和间接调用。
+ * 定时器存放在哈希时间轮中:槽位只保存节点下标,节点按值保存在连续的节点池里并通过空闲链表复用。
+ * 触发语义与BasicTimerManager一致:加入时立即触发一次,之后每隔interval触发,共repeat次。
+ * 区别在于落后(时钟跳变或驱动线程被阻塞)时:BasicTimerManager每轮Update对每个定时器只补一次,
+ * 这里一次Update按到期顺序补齐所有错过的触发。
+ *
+ * @tparam Clock 时间来源,同BasicTimeLineTimer
+ * @tparam Geometry 时间轮几何参数,见WheelGeometry
+ * @tparam Callbacks 所有可能的回调类型,需可无参调用
+ */
+template<class Clock, class Geometry, class... Callbacks>
+class BasicStaticTimerManager {
+public:
+    static_assert(sizeof...(Callbacks) > 0, "at least one callback type is required");
+
+    using Callback = std::variant<Callbacks...>;
+
+    BasicStaticTimerManager();
+    BasicStaticTimerManager(const BasicStaticTimerManager &) = delete;
+    BasicStaticTimerManager &operator=(const BasicStaticTimerManager &) = delete;
+
+    template<class F>
+    void AddTimer(std::size_t interval, F &&f, std::size_t repeat = -1); // 线程安全,在下一次Update时生效
+
+    std::size_t Update(); // 处理到当前时间为止的所有tick,返回本次触发的回调个数;回调抛出的异常会传出,未执行的定时器顺延到下一次Update
+    std::size_t Size(); // 当前定时器个数(含待添加的定时器)
+    void Clear(); // 清空所有定时器并以当前时间重新开始,需在驱动线程停止后调用
+
+    void SetDriverOptions(const DriverOptions &options); // 需在Start之前调用
+    void Start(); // 启动定时器,调用线程即为驱动线程
+    void Stop(); // 停止定时器
+
+private:
+    struct Node
+    {
+        std::size_t m_deadline; // 下一次触发的tick
+        std::size_t m_interval; // 间隔(tick)
+        std::size_t repeatCount; // 剩余触发次数
+        std::optional<Callback> m_callback; // 为空表示节点空闲
+    };
+
+    struct Pending
+    {
+        std::size_t m_deadline;
+        std::size_t m_interval;
+        std::size_t repeatCount;
+        Callback m_callback;
+    };
+
+    static std::size_t CurrentTick();
+    std::size_t EarliestDeadline() const; // 所有定时器中最早的到期tick,没有定时器时为-1
+    std::size_t Allocate(Pending &&pending); // 从节点池中分配节点,返回下标
+    std::size_t ProcessSlot(std::size_t tick); // 处理tick对应的槽位中已到期的节点
+    void Release(std::size_t index); // 定时器结束,节点放回空闲链表
+    void Wait(std::size_t idleRounds);
+
+    std::vector<Node> m_nodes; // 节点池
+    std::vector<std::size_t> m_free; // 空闲节点下标
+    std::vector<std::size_t> m_slots[Geometry::kSlots]; // 每个槽位保存的节点下标
+    std::vector<std::size_t> m_rescheduled; // 当前tick触发后需要重新放回时间轮的节点,复用容量
+    std::size_t m_nextTick; // 下一个待处理的tick,仅驱动线程访问
+    std::atomic<std::size_t> m_size{0}; // 时间轮中的定时器个数,只由驱动线程修改,Size()可在其他线程读取
+
+    std::vector<Pending> m_task_queue; // 待添加的定时器
+    std::mutex m_mutex_queue; // 保护task_queue
+    std::atomic<std::size_t> m_pendingCount{0};
+
+    DriverOptions m_options;
+    std::atomic<bool> m_isRunning{false};
+};
+
+template<class Geometry, class... Callbacks>
+using StaticTimerManager = BasicStaticTimerManager<FastSteadyClock, Geometry, Callbacks...>;
+
+template<class Clock, class Geometry, class... Callbacks>
+BasicStaticTimerManager<Clock, Geometry, Callbacks...>::BasicStaticTimerManager()
+: m_nextTick(CurrentTick())
+{
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+std::size_t BasicStaticTimerManager<Clock, Geometry, Callbacks...>::CurrentTick()
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+    return Geometry::ToTick(static_cast<std::size_t>(ms));
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+template<class F>
+void BasicStaticTimerManager<Clock, Geometry, Callbacks...>::AddTimer(std::size_t interval, F &&f, std::size_t repeat)
+{
+    using Type = std::decay_t<F>;
+    static_assert((std::is_same_v<Type, Callbacks> || ...), "callback type is not one of Callbacks");
+    if (repeat == 0)
+    {
+        return;
+    }
+    Pending pending{CurrentTick(), Geometry::ToTicks(interval), repeat,
+                    Callback(std::in_place_type<Type>, std::forward<F>(f))};
+    std::lock_guard<std::mutex> lock(m_mutex_queue);
+    m_task_queue.push_back(std::move(pending));
+    m_pendingCount.fetch_add(1, std::memory_order_release);
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+std::size_t BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Allocate(Pending &&pending)
+{
+    std::size_t index;
+    if (m_free.empty())
+    {
+        index = m_nodes.size();
+        m_nodes.push_back(Node{0, 0, 0, std::nullopt});
+    }
+    else
+    {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    auto &node = m_nodes[index];
+    // 在当前tick已经处理过之后才加入的定时器,放到下一个待处理的tick,避免要等时间轮转一整圈
+    node.m_deadline = std::max(pending.m_deadline, m_nextTick);
+    node.m_interval = pending.m_interval;
+    node.repeatCount = pending.repeatCount;
+    node.m_callback.emplace(std::move(pending.m_callback));
+    return index;
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+std::size_t BasicStaticTimerManager<Clock, Geometry, Callbacks...>::ProcessSlot(std::size_t tick)
+{
+    std::size_t fired = 0;
+    auto &slot = m_slots[Geometry::SlotOf(tick)];
+    std::size_t kept = 0;
+    std::size_t i = 0;
+    // 压缩槽位并放回本tick重新调度的节点;回调抛出异常时同样执行,尚未处理的节点原样保留
+    auto finish = [&]() {
+        for (; i < slot.size(); ++i)
+        {
+            slot[kept++] = slot[i];
+        }
+        slot.resize(kept);
+        for (auto index : m_rescheduled)
+        {
+            m_slots[Geometry::SlotOf(m_nodes[index].m_deadline)].push_back(index);
+        }
+        m_rescheduled.clear();
+    };
+    for (; i < slot.size(); ++i)
+    {
+        std::size_t index = slot[i];
+        auto &node = m_nodes[index];
+        if (node.m_deadline > tick) // 属于之后的某一圈
+        {
+            slot[kept++] = index;
+            continue;
+        }
+        // 先更新剩余次数和下一次到期时间,回调抛出异常时本次触发同样计入
+        ++fired;
+        bool last = --node.repeatCount == 0;
+        node.m_deadline += node.m_interval;
+        if (!last)
+        {
+            m_rescheduled.push_back(index);
+        }
+        try
+        {
+            std::visit([](auto &callback) { callback(); }, *node.m_callback);
+        }
+        catch (...)
+        {
+            if (last)
+            {
+                Release(index);
+            }
+            ++i;
+            finish();
+            throw;
+        }
+        if (last)
+        {
+            Release(index);
+        }
+    }
+    finish();
+    return fired;
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+void BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Release(std::size_t index)
+{
+    m_nodes[index].m_callback.reset();
+    m_free.push_back(index);
+    m_size.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+std::size_t BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Update()
+{
+    if (m_pendingCount.load(std::memory_order_acquire) > 0)
+    {
+        std::vector<Pending> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_queue);
+            pending.swap(m_task_queue);
+            m_pendingCount.store(0, std::memory_order_relaxed);
+        }
+        for (auto &p : pending)
+        {
+            std::size_t index = Allocate(std::move(p));
+            m_slots[Geometry::SlotOf(m_nodes[index].m_deadline)].push_back(index);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t fired = 0;
+    std::size_t nowTick = CurrentTick();
+    if (nowTick < m_nextTick)
+    {
+        return fired;
+    }
+    // 逐个tick按顺序处理,保证落后时补齐的触发仍按到期顺序执行;
+    // 连续一整圈都没有定时器到期时,说明剩余定时器都在更远的圈,直接跳到最早的到期tick
+    std::size_t idle = 0;
+    for (std::size_t tick = m_nextTick; tick <= nowTick;)
+    {
+        std::size_t n;
+        try
+        {
+            n = ProcessSlot(tick);
+        }
+        catch (...)
+        {
+            m_nextTick = tick; // 该tick中尚未执行的定时器在下一次Update时补上
+            throw;
+        }
+        fired += n;
+        idle = n > 0 ? 0 : idle + 1;
+        if (idle >= Geometry::kSlots)
+        {
+            idle = 0;
+            tick = std::max(tick + 1, EarliestDeadline());
+            continue;
+        }
+        ++tick;
+    }
+    m_nextTick = nowTick + 1;
+    return fired;
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+std::size_t BasicStaticTimerManager<Clock, Geometry, Callbacks...>::EarliestDeadline() const
+{
+    std::size_t earliest = static_cast<std::size_t>(-1);
+    for (const auto &node : m_nodes)
+    {
+        if (node.m_callback.has_value())
+        {
+            earliest = std::min(earliest, node.m_deadline);
+        }
+    }
+    return earliest;
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+std::size_t BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Size()
+{
+    std::lock_guard<std::mutex> lock(m_mutex_queue);
+    return m_size.load(std::memory_order_relaxed) + m_task_queue.size();
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+void BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex_queue);
+    m_task_queue.clear();
+    m_pendingCount.store(0);
+    for (auto &slot : m_slots)
+    {
+        slot.clear();
+    }
+    m_nodes.clear();
+    m_free.clear();
+    m_size.store(0);
+    m_nextTick = CurrentTick();
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+void BasicStaticTimerManager<Clock, Geometry, Callbacks...>::SetDriverOptions(const DriverOptions &options)
+{
+    m_options = options;
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+void BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Start()
+{
+    ApplyDriverThreadOptions(m_options);
+    m_isRunning.store(true);
+    std::size_t idleRounds = 0;
+    while (m_isRunning.load())
+    {
+        if (Update() > 0)
+        {
+            idleRounds = 0;
+        }
+        else
+        {
+            Wait(idleRounds++);
+        }
+    }
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+void BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Wait(std::size_t idleRounds)
+{
+    // 时间轮本身以tick为精度,SpinPark和Sleep都退化为休眠至多一个tick
+    switch (m_options.strategy)
+    {
+        case WaitStrategy::BusySpin:
+            CpuRelax();
+            break;
+        case WaitStrategy::SpinYield:
+        case WaitStrategy::SpinPark:
+            if (idleRounds < m_options.spinCount)
+            {
+                CpuRelax();
+            }
+            else if (m_options.strategy == WaitStrategy::SpinYield)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(Geometry::kTickMs));
+            }
+            break;
+        case WaitStrategy::Sleep:
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::min(Geometry::kTickMs, m_options.sleepMs)));
+            break;
+    }
+}
+
+template<class Clock, class Geometry, class... Callbacks>
+void BasicStaticTimerManager<Clock, Geometry, Callbacks...>::Stop()
+{
+    m_isRunning.store(false);
+}
+
+} // cxk
+
+#endif //STEADYTIMER_STATICTIMERMANAGER_H
@@ -8,8 +8,27 @@
 #include <map>
 #include "Singleton.h"
 #include <mutex>
-#include <queue>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <atomic>
+#include <thread>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <tuple>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include "clock.h"
+#include "WaitStrategy.h"
+#include "TimerSnapshot.h"
+#include "BurstExecutor.h"
 
 namespace cxk
 {
@@ -17,19 +36,27 @@ namespace cxk
 /*
  * \@brief 时间轴定时器类
  * 该类用于实现基于时间轴的定时器功能，支持设置回调函数和重复次数。
+ * Clock为时间来源,需提供静态的now()(兼容std::chrono时钟接口),默认为FastSteadyClock,
+ * 仿真和测试中可替换为VirtualClock
  */
 
-class TimeLineTimer {
+template<class Clock>
+class BasicTimeLineTimer {
 public:
-    friend class TimerManager;
+    template<class> friend class BasicTimerManager;
 
     using TimerCallback = std::function<void()>;
-    explicit TimeLineTimer()noexcept;
+    using PersistentHandler = std::function<void(const std::string &)>; // 可持久化定时器的处理函数,参数为payload
+    explicit BasicTimeLineTimer()noexcept;
+    BasicTimeLineTimer(const BasicTimeLineTimer &) = default;
+    BasicTimeLineTimer(BasicTimeLineTimer &&) noexcept = default;
+    BasicTimeLineTimer &operator=(const BasicTimeLineTimer &) = default;
+    BasicTimeLineTimer &operator=(BasicTimeLineTimer &&) noexcept = default;
 
     template<class Func,typename...Arg>
-    explicit TimeLineTimer(std::size_t interval,Func&&f,Arg&&...arg,std::size_t repeat=-1); // 设置回调函数
+    explicit BasicTimeLineTimer(std::size_t interval,Func&&f,Arg&&...arg,std::size_t repeat=-1); // 设置回调函数
 
-    explicit TimeLineTimer(std::size_t interval,TimerCallback& callback,std::size_t repeat=-1); // 设置回调函数
+    explicit BasicTimeLineTimer(std::size_t interval,TimerCallback& callback,std::size_t repeat=-1); // 设置回调函数
 
     template<class Func,typename...Arg>
     void ResetTimer(int interval,Func&&f,Arg&&...arg,std::size_t repeat=-1); // 设置回调函数
@@ -37,17 +64,28 @@ public:
     void Trigger();
     static std::size_t GetCurrentTime();
 
-    ~TimeLineTimer();
+    ~BasicTimeLineTimer();
 
 private:
+    std::uint64_t m_id = 0; // 由BasicTimerManager分配,用于取消
     std::size_t repeatCount; // 重复次数
     std::size_t m_startTime,m_endTime;
     TimerCallback m_callback;
     std::size_t m_interval; // ms
+    // 可持久化定时器不使用m_callback,而是以payload调用注册的处理函数,以便写入快照后在新进程中恢复
+    const PersistentHandler *m_handler = nullptr;
+    std::uint32_t m_handlerId = 0;
+    std::string m_payload;
+    std::size_t m_group = 0; // 突发并行触发时的顺序约束,同一非0组内串行执行
+    bool m_invoked = false; // BasicTimerManager本轮批次中回调是否已经执行,仅由执行该定时器的线程写入
+
+    void Advance(); // 计入一次触发:更新下一次的开始时间和剩余次数
+    void Invoke(); // 只执行回调
 };
 
+template<class Clock>
 template<class Func, typename... Arg>
-TimeLineTimer::TimeLineTimer(std::size_t interval, Func &&f, Arg &&... arg, std::size_t repeat)
+BasicTimeLineTimer<Clock>::BasicTimeLineTimer(std::size_t interval, Func &&f, Arg &&... arg, std::size_t repeat)
 {
     m_interval = interval;
     m_callback = [f = std::forward<Func>(f), args = std::make_tuple(std::forward<Arg>(arg)...)]() mutable {
@@ -59,8 +97,9 @@ TimeLineTimer::TimeLineTimer(std::size_t interval, Func &&f, Arg &&... arg, std:
 }
 
 
+template<class Clock>
 template<class Func, typename... Arg>
-void TimeLineTimer::ResetTimer(int interval, Func &&f, Arg &&... arg, std::size_t repeat)
+void BasicTimeLineTimer<Clock>::ResetTimer(int interval, Func &&f, Arg &&... arg, std::size_t repeat)
 {
     m_interval = interval;
     m_callback = [f = std::forward<Func>(f), args = std::make_tuple(std::forward<Arg>(arg)...)]() mutable {
@@ -73,38 +112,997 @@ void TimeLineTimer::ResetTimer(int interval, Func &&f, Arg &&... arg, std::size_
 }
 
 
+template<class Clock>
+BasicTimeLineTimer<Clock>::BasicTimeLineTimer() noexcept
+: repeatCount(-1), m_startTime(0), m_endTime(0), m_interval(0)
+{
+    m_startTime = GetCurrentTime();
+}
+
+
+template<class Clock>
+BasicTimeLineTimer<Clock>::BasicTimeLineTimer(std::size_t interval, TimerCallback &callback, std::size_t repeat)
+: repeatCount(repeat), m_startTime(0), m_endTime(0), m_callback(callback), m_interval(interval)
+{
+    m_startTime = GetCurrentTime();
+    if(m_interval>0&&repeatCount>std::numeric_limits<std::size_t>::max()/m_interval)
+    {
+        repeatCount = std::numeric_limits<std::size_t>::max()/m_interval; // 防止溢出
+    }
+    m_endTime = m_startTime + m_interval * repeatCount; // 计算结束时间
+}
+
+
+template<class Clock>
+void BasicTimeLineTimer<Clock>::SetRepeatCount(int count)
+{
+
+}
+
+template<class Clock>
+void BasicTimeLineTimer<Clock>::Trigger()
+{
+    if((m_callback== nullptr&&m_handler== nullptr)||repeatCount==0) // 没有设置回调函数,m_callback为空
+    {
+        return;
+    }
+    // 先更新下一次的开始时间和剩余次数,回调抛出异常时本次触发同样计入,不会在下一轮重复触发
+    Advance();
+    Invoke();
+}
+
+template<class Clock>
+void BasicTimeLineTimer<Clock>::Advance()
+{
+    m_startTime+=m_interval; // 更新下一次的开始时间
+    repeatCount--;
+}
+
+template<class Clock>
+void BasicTimeLineTimer<Clock>::Invoke()
+{
+    if(m_handler!= nullptr)
+    {
+        (*m_handler)(m_payload);
+    }
+    else
+    {
+        m_callback();
+    }
+}
+
+template<class Clock>
+std::size_t BasicTimeLineTimer<Clock>::GetCurrentTime()
+{
+    // 转换为毫秒
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+}
+
+template<class Clock>
+BasicTimeLineTimer<Clock>::~BasicTimeLineTimer()
+{
+
+}
+
+using TimeLineTimer = BasicTimeLineTimer<FastSteadyClock>;
+
+/**
+ * \@brief 定时器优先级
+ * 同一批到期的定时器中,高优先级的回调先执行;High还可以交给独立的驱动线程处理
+ */
+enum class TimerPriority
+{
+    High = 0,
+    Normal = 1,
+    Low = 2,
+};
+constexpr std::size_t kTimerPriorityCount = 3;
+
+void ReportSlowCallback(TimerPriority priority, std::size_t elapsedUs, std::size_t budgetUs); // 看门狗默认告警,输出到spdlog
+
 /**
  * \@brief 定时器管理类
  * 该类用于管理多个时间轴定时器实例，提供添加、更新和启动等功能。调度的间隔在这是设计
+ * 每个优先级对应一条独立的通道(lane),Update按优先级从高到低处理各通道中已到期的定时器
+ * Clock与BasicTimeLineTimer相同,使用VirtualClock时可以不启动驱动线程,手动推进时钟后调用Update
  */
-class TimerManager {
-    SINGLETON(TimerManager)
+template<class Clock>
+class BasicTimerManager {
+    SINGLETON_WITH_DESTRUCTOR(BasicTimerManager) // 析构时停止驱动线程,避免析构可join的std::thread
 public:
+    using Timer = BasicTimeLineTimer<Clock>;
+    using TimerId = std::uint64_t; // 低2位为优先级,其余位为递增序号,0表示无效
+    // 回调执行超出看门狗预算时调用,参数为定时器优先级和耗时(us);回调仍未返回时由监控线程上报已执行的时间,
+    // 每次回调最多上报一次。处理函数可能在监控线程、驱动线程或突发辅助线程上并发调用
+    using WatchdogHandler = std::function<void(TimerPriority, std::size_t)>;
 
     template<class F,typename...Args>
-    void AddTimer(std::size_t interval,F&&f,Args&&...args, std::size_t repeat=-1);
+    TimerId AddTimer(std::size_t interval,F&&f,Args&&...args, std::size_t repeat=-1,
+                     TimerPriority priority=TimerPriority::Normal, std::size_t group=0);
 
-    void AddTimer(std::size_t interval, TimeLineTimer::TimerCallback &callback, std::size_t repeat=-1);
+    TimerId AddTimer(std::size_t interval, typename Timer::TimerCallback &callback, std::size_t repeat=-1,
+                     TimerPriority priority=TimerPriority::Normal, std::size_t group=0);
 
-    void Update(); // 更新定时器状态
-    void Start(); // 启动定时器
-    void Stop(); // 停止定时器
+    // 注册可持久化定时器的处理函数,需在AddPersistentTimer/Restore和Start之前调用
+    void RegisterHandler(std::uint32_t handlerId, typename Timer::PersistentHandler handler);
+    // 添加可持久化定时器,触发时以payload调用handlerId对应的处理函数;handlerId未注册时返回0
+    TimerId AddPersistentTimer(std::size_t interval, std::uint32_t handlerId, std::string payload,
+                               std::size_t repeat=-1, TimerPriority priority=TimerPriority::Normal);
+    // 将所有可持久化定时器写入快照文件,普通回调定时器无法序列化,会被跳过。
+    // 执行回调时不持有通道的锁,可以在定时器回调中调用(例如周期性保存快照),本接口与Restore/Size/Cancel均如此
+    bool Snapshot(const std::string &path, std::size_t *saved=nullptr);
+    // 从快照文件批量恢复定时器;elapseDowntime为true时,两次进程之间经过的系统时间也计入已等待的时间
+    bool Restore(const std::string &path, bool elapseDowntime=true, std::size_t *restored=nullptr);
+
+    void Cancel(TimerId id); // 取消定时器,在下一次到期时丢弃;取消已结束的定时器无副作用
+    void Clear(); // 清空所有定时器,需在驱动线程停止后调用;在回调中调用时,本轮正在执行的定时器也会在执行完后丢弃
+    std::size_t Size(); // 当前定时器个数(含未合并的待添加定时器和已取消但未丢弃的定时器)
+    std::size_t CancelledSize(); // 已取消但尚未到期丢弃的定时器个数,不超过Size()
+    std::size_t NextDeadline() const; // 上一次Update之后最早的到期时间(ms),没有定时器时为-1;StartHighPriorityDriver运行期间不含High通道
+
+    void SetDriverOptions(const DriverOptions &options); // 设置驱动线程的等待策略,需在Start之前调用
+    void SetTickBudget(std::size_t budget); // 每轮Update最多执行的Normal/Low回调个数,超出部分顺延到下一轮,-1表示不限制
+    // 回调耗时超过budgetUs时告警,-1表示关闭。预算与处理函数一起设置,需在Start/StartHighPriorityDriver之前调用;
+    // 驱动线程运行期间由监控线程检测卡住的回调,只手动调用Update时仅在回调返回后检查
+    void SetWatchdog(std::size_t budgetUs, WatchdogHandler handler=nullptr);
+    // 单轮同一通道到期的定时器超过threshold个时,由helpers个辅助线程与驱动线程并行触发;
+    // 同一通道内同一group(非0)的定时器在同一线程上按到期顺序串行执行,不同group及group为0的定时器之间没有顺序保证,
+    // 看门狗处理函数也可能被并发调用。group只在通道内生效:StartHighPriorityDriver之后High通道由独立线程处理,
+    // 与其他通道中同一group的定时器可能同时执行。threshold为-1或helpers为0时关闭,需在Start之前调用。
+    // 回调抛出异常时,该worker剩余的定时器顺延到下一轮,其余worker照常执行,之后异常从Update中抛出
+    void SetBurstOptions(std::size_t threshold, std::size_t helpers);
+    std::size_t Update(); // 更新定时器状态,返回本次触发的回调个数;回调抛出的异常会传出,本轮未执行的定时器顺延到下一轮
+    void Start(); // 启动定时器,调用线程即为驱动线程
+    void StartHighPriorityDriver(const DriverOptions &options); // 启动独立线程专门处理High通道
+    void Stop(); // 停止定时器(包括High通道的独立驱动线程)
 private:
-    std::multimap<std::size_t , TimeLineTimer> m_timers; // 用于存储时间轴定时器,时间轴定时器按照开始时间排序
-    std::queue<std::pair<std::size_t,TimeLineTimer>> m_task_queue; // 用于存储待定添加的定时器
-    std::atomic<bool> m_isRunning{}; // 定时器是否正在运行
-    std::mutex m_mutex_queue; // 保护task_queue
+    using TimerNode = typename std::multimap<std::size_t , Timer>::node_type;
+
+    struct Lane
+    {
+        std::multimap<std::size_t , Timer> m_timers; // 用于存储时间轴定时器,时间轴定时器按照开始时间排序
+        std::deque<Timer> m_task_queue; // 用于存储待定添加的定时器
+        std::vector<TimerId> m_cancel_queue; // 待处理的取消请求,与task_queue一同由m_mutex_queue保护
+        std::unordered_set<TimerId> m_cancelled; // 已取消但尚未到期的定时器,由m_mutex_timers保护
+        std::unordered_set<TimerId> m_live; // m_timers中定时器的id,只有仍存活的id才会进入m_cancelled
+        std::vector<TimerNode> m_ready; // 本轮已到期的定时器,触发后重新插回,复用容量
+        bool m_inFlight = false; // m_ready中的定时器正在执行回调(此时不持有m_mutex_timers),由m_mutex_timers保护
+        bool m_dropReady = false; // 执行回调期间调用了Clear,批次结束时丢弃m_ready
+        std::mutex m_mutex_queue; // 保护task_queue
+        std::mutex m_mutex_timers; // 保护m_timers,处理该通道的驱动线程持有
+    };
+
+    // 正在执行回调的线程登记的看门狗状态,监控线程据此发现卡住的回调
+    struct WatchSlot
+    {
+        std::atomic<std::int64_t> m_startNs{0}; // 当前回调开始时间(ns),0表示空闲,取负表示已由监控线程上报
+        std::atomic<TimerPriority> m_priority{TimerPriority::Normal};
+    };
+
+    struct Driver
+    {
+        DriverOptions m_options; // 驱动线程配置
+        std::size_t m_firstLane = 0, m_lastLane = kTimerPriorityCount; // 负责的通道范围[first,last)
+        std::size_t m_nextDeadline{static_cast<std::size_t>(-1)}; // 下一个到期时间(ms),仅驱动线程访问
+        std::atomic<bool> m_isRunning{}; // 驱动线程是否正在运行
+        std::atomic<uint32_t> m_wakeSeq{0}; // futex字,每次有新定时器或停止时递增
+        std::atomic<bool> m_parked{false}; // 驱动线程是否可能处于挂起状态
+        WatchSlot m_watch; // 驱动线程自身执行回调时使用
+    };
+
+    TimerId Push(Timer &&timer, TimerPriority priority); // 放入对应通道的task_queue并唤醒驱动线程
+    std::size_t UpdateLanes(Driver &driver);
+    std::size_t UpdateLane(Lane &lane, std::size_t currentTime, std::size_t budget, std::size_t &nextDeadline,
+                           WatchSlot &watch);
+    void TriggerOne(Timer &timer, TimerPriority priority, WatchSlot &watch); // 触发单个定时器,开启看门狗时登记并统计耗时
+    void TriggerBurst(std::vector<TimerNode> &ready, TimerPriority priority); // 由辅助线程并行触发一批定时器
+    // 批次结束:将m_ready中的定时器按新的到期时间放回m_timers,已结束的丢弃;回调抛出异常时未执行的定时器恢复原到期时间
+    void FinishBatch(Lane &lane, std::size_t &nextDeadline);
+    void Run(Driver &driver); // 驱动循环
+    void Wait(Driver &driver, std::size_t idleRounds); // 按等待策略在两次Update之间等待
+    void Notify(Driver &driver); // 通知可能挂起的驱动线程
+    void StartWatchdog(); // 开启看门狗时启动监控线程,已启动则忽略
+    void WatchdogLoop();
+    void CheckWatchSlot(WatchSlot &watch, std::int64_t now); // 发现超出预算仍未返回的回调时上报
+    void ReportWatchdog(TimerPriority priority, std::size_t elapsedUs);
+    static std::int64_t WatchNowNs(); // 看门狗统计的是真实耗时,与Clock无关
+
+    Lane m_lanes[kTimerPriorityCount];
+    Driver m_driver; // 主驱动,由调用Start的线程运行
+    Driver m_highDriver; // High通道的独立驱动
+    std::thread m_highThread;
+    std::atomic<bool> m_highDedicated{false}; // High通道是否由独立驱动线程处理
+    std::atomic<std::uint64_t> m_nextId{1}; // 下一个定时器序号
+    std::atomic<std::size_t> m_tickBudget{static_cast<std::size_t>(-1)};
+    std::size_t m_watchdogBudgetUs = static_cast<std::size_t>(-1); // 与处理函数一样只在Start之前修改
+    WatchdogHandler m_watchdogHandler;
+    std::thread m_watchdogThread; // 监控线程,检查各WatchSlot
+    std::atomic<bool> m_watchdogRunning{false};
+    std::mutex m_watchdogMutex;
+    std::condition_variable m_watchdogCv; // Stop时唤醒监控线程
+    std::unordered_map<std::uint32_t, typename Timer::PersistentHandler> m_handlers; // 节点地址稳定,定时器直接引用
 
+    std::size_t m_burstThreshold = static_cast<std::size_t>(-1); // 单轮到期个数超过该值时并行触发
+    std::unique_ptr<BurstExecutor> m_burst; // 辅助线程,未开启时为空
+    std::mutex m_burstMutex; // 保护辅助线程及下面的分组缓存,High通道独立驱动与主驱动可能同时遇到突发
+    std::vector<std::vector<std::size_t>> m_burstGrouped; // 每个worker负责的有序组定时器下标
+    std::vector<std::size_t> m_burstUngrouped; // 无序定时器下标
+    std::unique_ptr<WatchSlot[]> m_burstWatch; // 每个突发worker一个,与m_burst一同创建
 };
 
+template<class Clock>
 template<class F, typename... Args>
-void TimerManager::AddTimer(std::size_t interval, F &&f, Args &&... args, std::size_t repeat)
+typename BasicTimerManager<Clock>::TimerId
+BasicTimerManager<Clock>::AddTimer(std::size_t interval, F &&f, Args &&... args, std::size_t repeat, TimerPriority priority,
+                                   std::size_t group)
+{
+    Timer timer(interval, std::forward<F>(f), std::forward<Args>(args)..., repeat);
+    timer.m_group = group;
+    return Push(std::move(timer), priority);
+}
+
+template<class Clock>
+typename BasicTimerManager<Clock>::TimerId
+BasicTimerManager<Clock>::AddTimer(std::size_t interval, typename Timer::TimerCallback &callback, std::size_t repeat,
+                                   TimerPriority priority, std::size_t group)
+{
+    Timer timer(interval, callback, repeat);
+    timer.m_group = group;
+    return Push(std::move(timer), priority);
+}
+
+template<class Clock>
+typename BasicTimerManager<Clock>::TimerId BasicTimerManager<Clock>::Push(Timer &&timer, TimerPriority priority)
+{
+    auto &lane = m_lanes[static_cast<std::size_t>(priority)];
+    timer.m_id = m_nextId.fetch_add(1, std::memory_order_relaxed) << 2 | static_cast<TimerId>(priority);
+    TimerId id = timer.m_id;
+    {
+        std::lock_guard<std::mutex> lock(lane.m_mutex_queue); // 保护task_queue
+        lane.m_task_queue.push_back(std::move(timer)); // 将时间轴定时器放入task_queue
+    }
+    bool dedicated = priority == TimerPriority::High && m_highDedicated.load();
+    Notify(dedicated ? m_highDriver : m_driver);
+    return id;
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::RegisterHandler(std::uint32_t handlerId, typename Timer::PersistentHandler handler)
+{
+    m_handlers[handlerId] = std::move(handler);
+}
+
+template<class Clock>
+typename BasicTimerManager<Clock>::TimerId
+BasicTimerManager<Clock>::AddPersistentTimer(std::size_t interval, std::uint32_t handlerId, std::string payload,
+                                             std::size_t repeat, TimerPriority priority)
+{
+    auto it = m_handlers.find(handlerId);
+    if (it == m_handlers.end() || repeat == 0)
+    {
+        return 0;
+    }
+    Timer timer;
+    timer.m_interval = interval;
+    timer.repeatCount = repeat;
+    timer.m_endTime = timer.m_startTime + interval * repeat;
+    timer.m_handler = &it->second;
+    timer.m_handlerId = handlerId;
+    timer.m_payload = std::move(payload);
+    return Push(std::move(timer), priority);
+}
+
+template<class Clock>
+bool BasicTimerManager<Clock>::Snapshot(const std::string &path, std::size_t *saved)
+{
+    std::vector<SnapshotRecord> records;
+    std::string payload;
+    for (std::size_t i = 0; i < kTimerPriorityCount; ++i)
+    {
+        auto &lane = m_lanes[i];
+        std::lock_guard<std::mutex> lock(lane.m_mutex_timers);
+        std::lock_guard<std::mutex> queueLock(lane.m_mutex_queue);
+        std::unordered_set<TimerId> cancelQueue(lane.m_cancel_queue.begin(), lane.m_cancel_queue.end());
+        auto collect = [&](const Timer &timer) {
+            if (timer.m_handler == nullptr || timer.repeatCount == 0 ||
+                timer.m_payload.size() > std::numeric_limits<std::uint32_t>::max() ||
+                lane.m_cancelled.count(timer.m_id) > 0 || cancelQueue.count(timer.m_id) > 0)
+            {
+                return;
+            }
+            SnapshotRecord record{};
+            record.deadline = timer.m_startTime;
+            record.interval = timer.m_interval;
+            record.repeatCount = timer.repeatCount;
+            record.payloadOffset = payload.size();
+            record.payloadSize = static_cast<std::uint32_t>(timer.m_payload.size());
+            record.handlerId = timer.m_handlerId;
+            record.priority = static_cast<std::uint32_t>(i);
+            records.push_back(record);
+            payload += timer.m_payload;
+        };
+        std::size_t laneBegin = records.size();
+        for (const auto &kv : lane.m_timers)
+        {
+            collect(kv.second);
+        }
+        for (const auto &timer : lane.m_task_queue)
+        {
+            collect(timer);
+        }
+        if (lane.m_inFlight && !lane.m_dropReady) // 正在执行回调的定时器已计入本次触发,状态不会再变化
+        {
+            for (const auto &node : lane.m_ready)
+            {
+                collect(node.mapped());
+            }
+        }
+        // task_queue中尚未合并的定时器追加在后面,按deadline重排后每个通道内的记录有序,恢复时可以直接追加到末尾
+        std::stable_sort(records.begin() + static_cast<std::ptrdiff_t>(laneBegin), records.end(),
+                         [](const SnapshotRecord &a, const SnapshotRecord &b) { return a.deadline < b.deadline; });
+    }
+
+    SnapshotHeader header{};
+    std::copy(std::begin(kSnapshotMagic), std::end(kSnapshotMagic), header.magic);
+    header.version = kSnapshotVersion;
+    header.recordSize = sizeof(SnapshotRecord);
+    header.count = records.size();
+    header.payloadBytes = payload.size();
+    header.savedClockMs = Timer::GetCurrentTime();
+    header.savedWallMs = WallClockMs();
+
+    // 拼成一块连续的缓冲区,一次写入
+    std::size_t recordBytes = records.size() * sizeof(SnapshotRecord);
+    std::string buffer(sizeof(header) + recordBytes + payload.size(), '\0');
+    std::memcpy(&buffer[0], &header, sizeof(header));
+    if (recordBytes > 0)
+    {
+        std::memcpy(&buffer[sizeof(header)], records.data(), recordBytes);
+    }
+    if (!payload.empty())
+    {
+        std::memcpy(&buffer[sizeof(header) + recordBytes], payload.data(), payload.size());
+    }
+    if (!WriteFileAtomically(path, buffer.data(), buffer.size()))
+    {
+        return false;
+    }
+    if (saved != nullptr)
+    {
+        *saved = records.size();
+    }
+    return true;
+}
+
+template<class Clock>
+bool BasicTimerManager<Clock>::Restore(const std::string &path, bool elapseDowntime, std::size_t *restored)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+    const SnapshotHeader *header = nullptr;
+    const SnapshotRecord *records = nullptr;
+    const char *payload = nullptr;
+    if (!ParseSnapshot(file, header, records, payload))
+    {
+        errno = EINVAL;
+        ReportSnapshotError("parse", path);
+        return false;
+    }
+
+    // 快照中的deadline基于旧进程的时钟,换算成相对保存时刻的剩余时间后再加到当前时钟上
+    auto now = static_cast<std::int64_t>(Timer::GetCurrentTime());
+    std::int64_t downtime = elapseDowntime ? std::max<std::int64_t>(0, WallClockMs() - header->savedWallMs) : 0;
+    std::int64_t shift = now - static_cast<std::int64_t>(header->savedClockMs) - downtime;
+
+    std::size_t count = 0, skipped = 0;
+    std::size_t current = kTimerPriorityCount;
+    std::unique_lock<std::mutex> lock;
+    for (std::uint64_t i = 0; i < header->count; ++i)
+    {
+        const auto &record = records[i];
+        auto handler = m_handlers.find(record.handlerId);
+        if (record.priority >= kTimerPriorityCount || record.repeatCount == 0 || handler == m_handlers.end() ||
+            record.payloadOffset > header->payloadBytes || record.payloadSize > header->payloadBytes - record.payloadOffset)
+        {
+            ++skipped;
+            continue;
+        }
+        if (record.priority != current) // 记录按通道分组,每个通道只加一次锁
+        {
+            current = record.priority;
+            lock = std::unique_lock<std::mutex>(m_lanes[current].m_mutex_timers);
+        }
+        auto deadline = static_cast<std::size_t>(std::max(now, static_cast<std::int64_t>(record.deadline) + shift));
+        auto &timers = m_lanes[current].m_timers;
+        // 记录在通道内按deadline有序,max(now, ...)不改变顺序;通道原有的定时器更晚到期时提示失效,但结果仍然正确
+        auto it = timers.emplace_hint(timers.end(), deadline, Timer());
+        auto &timer = it->second;
+        timer.m_id = m_nextId.fetch_add(1, std::memory_order_relaxed) << 2 | static_cast<TimerId>(current);
+        m_lanes[current].m_live.insert(timer.m_id);
+        timer.m_startTime = deadline;
+        timer.m_interval = record.interval;
+        timer.repeatCount = record.repeatCount;
+        timer.m_endTime = deadline + record.interval * record.repeatCount;
+        timer.m_handler = &handler->second;
+        timer.m_handlerId = record.handlerId;
+        timer.m_payload.assign(payload + record.payloadOffset, record.payloadSize);
+        ++count;
+    }
+    if (lock.owns_lock())
+    {
+        lock.unlock();
+    }
+    if (skipped > 0)
+    {
+        ReportSnapshotSkipped(skipped, path);
+    }
+    // 恢复的定时器可能早于驱动线程当前等待的到期时间
+    Notify(m_driver);
+    Notify(m_highDriver);
+    if (restored != nullptr)
+    {
+        *restored = count;
+    }
+    return true;
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::Cancel(TimerId id)
+{
+    auto lane = static_cast<std::size_t>(id & 3);
+    if (id == 0 || lane >= kTimerPriorityCount)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_lanes[lane].m_mutex_queue);
+    m_lanes[lane].m_cancel_queue.push_back(id);
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::Clear()
+{
+    for (auto &lane : m_lanes)
+    {
+        std::lock_guard<std::mutex> lock(lane.m_mutex_timers);
+        std::lock_guard<std::mutex> queueLock(lane.m_mutex_queue);
+        lane.m_timers.clear();
+        lane.m_task_queue.clear();
+        lane.m_cancel_queue.clear();
+        lane.m_cancelled.clear();
+        lane.m_live.clear();
+        lane.m_dropReady = lane.m_inFlight; // 在回调中调用时,正在执行的定时器在批次结束时丢弃
+    }
+    m_driver.m_nextDeadline = static_cast<std::size_t>(-1);
+}
+
+template<class Clock>
+std::size_t BasicTimerManager<Clock>::Size()
+{
+    std::size_t size = 0;
+    for (auto &lane : m_lanes)
+    {
+        std::lock_guard<std::mutex> lock(lane.m_mutex_timers);
+        std::lock_guard<std::mutex> queueLock(lane.m_mutex_queue);
+        size += lane.m_timers.size() + lane.m_task_queue.size();
+        if (lane.m_inFlight && !lane.m_dropReady)
+        {
+            size += lane.m_ready.size();
+        }
+    }
+    return size;
+}
+
+template<class Clock>
+std::size_t BasicTimerManager<Clock>::CancelledSize()
+{
+    std::size_t size = 0;
+    for (auto &lane : m_lanes)
+    {
+        std::lock_guard<std::mutex> lock(lane.m_mutex_timers);
+        size += lane.m_cancelled.size();
+    }
+    return size;
+}
+
+template<class Clock>
+std::size_t BasicTimerManager<Clock>::NextDeadline() const
+{
+    return m_driver.m_nextDeadline;
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::SetDriverOptions(const DriverOptions &options)
+{
+    m_driver.m_options = options;
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::SetTickBudget(std::size_t budget)
+{
+    m_tickBudget.store(budget);
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::SetWatchdog(std::size_t budgetUs, WatchdogHandler handler)
+{
+    m_watchdogHandler = std::move(handler);
+    m_watchdogBudgetUs = budgetUs;
+}
+
+template<class Clock>
+std::size_t BasicTimerManager<Clock>::Update()
+{
+    // High通道交给独立驱动时,主驱动只处理剩余通道
+    m_driver.m_firstLane = m_highDedicated.load() ? 1 : 0;
+    return UpdateLanes(m_driver);
+}
+
+template<class Clock>
+std::size_t BasicTimerManager<Clock>::UpdateLanes(Driver &driver)
+{
+    std::size_t fired = 0;
+    std::size_t budget = m_tickBudget.load();
+    driver.m_nextDeadline = static_cast<std::size_t>(-1);
+    auto currentTime = Timer::GetCurrentTime();
+    for (std::size_t i = driver.m_firstLane; i < driver.m_lastLane; ++i) // 按优先级从高到低
+    {
+        if (i == static_cast<std::size_t>(TimerPriority::High)) // High通道不受每轮预算限制
+        {
+            fired += UpdateLane(m_lanes[i], currentTime, static_cast<std::size_t>(-1), driver.m_nextDeadline,
+                                driver.m_watch);
+        }
+        else
+        {
+            std::size_t n = UpdateLane(m_lanes[i], currentTime, budget, driver.m_nextDeadline, driver.m_watch);
+            fired += n;
+            budget = budget == static_cast<std::size_t>(-1) ? budget : budget - n;
+        }
+    }
+    return fired;
+}
+
+template<class Clock>
+std::size_t BasicTimerManager<Clock>::UpdateLane(Lane &lane, std::size_t currentTime, std::size_t budget,
+                                                 std::size_t &nextDeadline, WatchSlot &watch)
+{
+    std::size_t fired = 0;
+    auto priority = static_cast<TimerPriority>(&lane - m_lanes);
+    auto &ready = lane.m_ready;
+    {
+        std::lock_guard <std::mutex> lock(lane.m_mutex_timers);
+        if (lane.m_inFlight) // 另一个驱动正在执行该通道的回调(High通道刚交给独立驱动时)
+        {
+            return fired;
+        }
+        {
+            std::lock_guard <std::mutex> queueLock(lane.m_mutex_queue);
+            if (lane.m_timers.empty() && lane.m_task_queue.empty()) // 如果定时器和队列为空,则直接返回
+            {
+                lane.m_cancel_queue.clear();
+                lane.m_cancelled.clear();
+                return fired;
+            }
+            while (!lane.m_task_queue.empty())
+            {
+                auto &timer = lane.m_task_queue.front();
+                lane.m_live.insert(timer.m_id);
+                lane.m_timers.emplace(timer.m_startTime, std::move(timer)); // 以下一次触发时间为键
+                lane.m_task_queue.pop_front();
+            }
+            for (auto id : lane.m_cancel_queue)
+            {
+                if (lane.m_live.count(id) > 0) // 已结束或无效的id直接丢弃,m_cancelled的大小不超过存活定时器个数
+                {
+                    lane.m_cancelled.insert(id);
+                }
+            }
+            lane.m_cancel_queue.clear();
+        }
+        auto &timers = lane.m_timers;
+        // m_timers按触发时间有序,只需取出头部已到期的部分;触发后再统一插回,避免零间隔定时器在同一轮反复触发
+        while (!timers.empty() && timers.begin()->first <= currentTime && ready.size() < budget) // 超出预算的部分留到下一轮
+        {
+            auto node = timers.extract(timers.begin());
+            auto &timer = node.mapped();
+            if (timer.m_callback == nullptr && timer.m_handler == nullptr) // 没有回调的定时器直接丢弃
+            {
+                lane.m_live.erase(timer.m_id);
+                continue;
+            }
+            if (!lane.m_cancelled.empty() && lane.m_cancelled.erase(timer.m_id) > 0) // 已取消的定时器在到期时丢弃
+            {
+                lane.m_live.erase(timer.m_id);
+                continue;
+            }
+            // 在锁内计入本次触发,执行回调期间定时器状态不再变化,Snapshot可以并发读取
+            timer.Advance();
+            ready.push_back(std::move(node));
+        }
+        fired = ready.size();
+        if (fired == 0)
+        {
+            if (!timers.empty())
+            {
+                nextDeadline = std::min(nextDeadline, timers.begin()->first);
+            }
+            return fired;
+        }
+        lane.m_inFlight = true;
+    }
+
+    // 执行回调时不持有m_mutex_timers,回调中可以调用Snapshot/Restore/Size/Cancel等接口
+    try
+    {
+        std::unique_lock<std::mutex> burstLock(m_burstMutex, std::defer_lock);
+        if (fired > m_burstThreshold && m_burst != nullptr && burstLock.try_lock()) // 辅助线程正被另一个驱动使用时退回单线程
+        {
+            TriggerBurst(ready, priority);
+        }
+        else
+        {
+            for (auto &node : ready)
+            {
+                TriggerOne(node.mapped(), priority, watch);
+            }
+        }
+    }
+    catch (...)
+    {
+        // 回调抛出异常时也要把本轮取出的定时器放回,未执行的恢复原到期时间,在下一轮触发
+        FinishBatch(lane, nextDeadline);
+        throw;
+    }
+    FinishBatch(lane, nextDeadline);
+    return fired;
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::FinishBatch(Lane &lane, std::size_t &nextDeadline)
+{
+    std::lock_guard<std::mutex> lock(lane.m_mutex_timers);
+    for (auto &node : lane.m_ready)
+    {
+        auto &timer = node.mapped();
+        if (!timer.m_invoked) // 只有回调抛出异常时才会出现
+        {
+            timer.m_startTime -= timer.m_interval;
+            timer.repeatCount++;
+        }
+        timer.m_invoked = false;
+        if (timer.repeatCount == 0 || lane.m_dropReady) // 如果定时器已经结束,则删除
+        {
+            lane.m_live.erase(timer.m_id);
+            continue;
+        }
+        node.key() = timer.m_startTime;
+        lane.m_timers.insert(std::move(node));
+    }
+    lane.m_ready.clear();
+    lane.m_inFlight = false;
+    lane.m_dropReady = false;
+    if (!lane.m_timers.empty())
+    {
+        nextDeadline = std::min(nextDeadline, lane.m_timers.begin()->first);
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::TriggerOne(Timer &timer, TimerPriority priority, WatchSlot &watch)
+{
+    timer.m_invoked = true; // 下一次的开始时间已在取出时更新,这里只执行回调
+    if (m_watchdogBudgetUs == static_cast<std::size_t>(-1))
+    {
+        timer.Invoke();
+        return;
+    }
+    auto begin = WatchNowNs();
+    watch.m_priority.store(priority, std::memory_order_relaxed);
+    watch.m_startNs.store(begin);
+    try
+    {
+        timer.Invoke();
+    }
+    catch (...)
+    {
+        watch.m_startNs.store(0); // 否则监控线程会把已经结束的回调当成卡住
+        throw;
+    }
+    auto started = watch.m_startNs.exchange(0);
+    auto elapsedUs = static_cast<std::size_t>((WatchNowNs() - begin) / 1000);
+    if (started > 0 && elapsedUs > m_watchdogBudgetUs) // started为负说明监控线程已经上报过
+    {
+        ReportWatchdog(priority, elapsedUs);
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::ReportWatchdog(TimerPriority priority, std::size_t elapsedUs)
+{
+    if (m_watchdogHandler)
+    {
+        m_watchdogHandler(priority, elapsedUs);
+    }
+    else
+    {
+        ReportSlowCallback(priority, elapsedUs, m_watchdogBudgetUs);
+    }
+}
+
+template<class Clock>
+std::int64_t BasicTimerManager<Clock>::WatchNowNs()
 {
-    auto timer = TimeLineTimer(interval, std::forward<F>(f), std::forward<Args>(args)..., repeat);
-    std::lock_guard<std::mutex> lock(m_mutex_queue); // 保护task_queue
-    m_task_queue.emplace(TimeLineTimer::GetCurrentTime(), timer); // 将时间轴定时器放入task_queue
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(FastSteadyClock::now().time_since_epoch()).count();
+    return std::max<std::int64_t>(1, ns); // 0表示空闲
 }
 
+template<class Clock>
+void BasicTimerManager<Clock>::StartWatchdog()
+{
+    bool expected = false;
+    if (m_watchdogBudgetUs == static_cast<std::size_t>(-1) ||
+        !m_watchdogRunning.compare_exchange_strong(expected, true))
+    {
+        return;
+    }
+    m_watchdogThread = std::thread([this]() {
+        SetCurrentThreadName("timer-watchdog");
+        WatchdogLoop();
+    });
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::WatchdogLoop()
+{
+    // 检查周期取预算的一半,上报最多比预算晚半个周期
+    auto period = std::chrono::microseconds(std::min<std::size_t>(std::max<std::size_t>(m_watchdogBudgetUs / 2, 100),
+                                                                  100000));
+    std::unique_lock<std::mutex> lock(m_watchdogMutex);
+    while (m_watchdogRunning.load())
+    {
+        m_watchdogCv.wait_for(lock, period);
+        auto now = WatchNowNs();
+        CheckWatchSlot(m_driver.m_watch, now);
+        CheckWatchSlot(m_highDriver.m_watch, now);
+        if (m_burstWatch != nullptr)
+        {
+            for (std::size_t i = 0; i < m_burst->Workers(); ++i)
+            {
+                CheckWatchSlot(m_burstWatch[i], now);
+            }
+        }
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::CheckWatchSlot(WatchSlot &watch, std::int64_t now)
+{
+    auto started = watch.m_startNs.load();
+    if (started <= 0 || static_cast<std::size_t>((now - started) / 1000) <= m_watchdogBudgetUs)
+    {
+        return;
+    }
+    // 与回调返回时的exchange竞争,只有一方会上报
+    if (watch.m_startNs.compare_exchange_strong(started, -started))
+    {
+        ReportWatchdog(watch.m_priority.load(std::memory_order_relaxed), static_cast<std::size_t>((now - started) / 1000));
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::TriggerBurst(std::vector<TimerNode> &ready, TimerPriority priority)
+{
+    // 有序组按组号固定分给某个worker,组内按到期顺序串行执行;无序的定时器由各worker按块动态领取
+    std::size_t workers = m_burst->Workers();
+    m_burstGrouped.resize(workers);
+    for (auto &chunk : m_burstGrouped)
+    {
+        chunk.clear();
+    }
+    m_burstUngrouped.clear();
+    for (std::size_t i = 0; i < ready.size(); ++i)
+    {
+        std::size_t group = ready[i].mapped().m_group;
+        if (group == 0)
+        {
+            m_burstUngrouped.push_back(i);
+        }
+        else
+        {
+            m_burstGrouped[group % workers].push_back(i);
+        }
+    }
+
+    constexpr std::size_t kBlock = 16; // 每次领取的定时器个数,兼顾负载均衡和原子操作开销
+    std::atomic<std::size_t> cursor{0};
+    m_burst->Run([&](std::size_t worker) {
+        for (auto i : m_burstGrouped[worker])
+        {
+            TriggerOne(ready[i].mapped(), priority, m_burstWatch[worker]);
+        }
+        while (true)
+        {
+            std::size_t begin = cursor.fetch_add(kBlock, std::memory_order_relaxed);
+            if (begin >= m_burstUngrouped.size())
+            {
+                break;
+            }
+            std::size_t end = std::min(begin + kBlock, m_burstUngrouped.size());
+            for (std::size_t j = begin; j < end; ++j)
+            {
+                TriggerOne(ready[m_burstUngrouped[j]].mapped(), priority, m_burstWatch[worker]);
+            }
+        }
+    });
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::SetBurstOptions(std::size_t threshold, std::size_t helpers)
+{
+    std::lock_guard<std::mutex> lock(m_burstMutex);
+    m_burstThreshold = threshold;
+    m_burst.reset();
+    m_burstWatch.reset();
+    if (helpers > 0 && threshold != static_cast<std::size_t>(-1))
+    {
+        m_burst = std::make_unique<BurstExecutor>(helpers);
+        m_burstWatch = std::make_unique<WatchSlot[]>(m_burst->Workers());
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::Start()
+{
+    m_driver.m_isRunning.store(true);
+    StartWatchdog();
+    Run(m_driver);
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::StartHighPriorityDriver(const DriverOptions &options)
+{
+    bool expected = false;
+    if (!m_highDedicated.compare_exchange_strong(expected, true))
+    {
+        return; // 已经启动
+    }
+    StartWatchdog();
+    m_highDriver.m_options = options;
+    m_highDriver.m_firstLane = static_cast<std::size_t>(TimerPriority::High);
+    m_highDriver.m_lastLane = m_highDriver.m_firstLane + 1;
+    m_highDriver.m_isRunning.store(true);
+    m_highThread = std::thread([this]() {
+        Run(m_highDriver);
+    });
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::Run(Driver &driver)
+{
+    ApplyDriverThreadOptions(driver.m_options);
+    std::size_t idleRounds = 0; // 连续未触发任何定时器的轮数
+    while(driver.m_isRunning.load())
+    {
+        if ((&driver == &m_driver ? Update() : UpdateLanes(driver)) > 0)
+        {
+            idleRounds = 0;
+        }
+        else
+        {
+            Wait(driver, idleRounds++);
+        }
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::Wait(Driver &driver, std::size_t idleRounds)
+{
+    // 距离下一个到期时间的剩余时间,按纳秒计算:到期时间是毫秒整数,用取整后的当前毫秒相减最多会晚醒1ms
+    auto timeout = std::chrono::nanoseconds::max();
+    if (driver.m_nextDeadline != static_cast<std::size_t>(-1))
+    {
+        auto deadline = std::chrono::milliseconds(driver.m_nextDeadline);
+        auto now = Clock::now().time_since_epoch();
+        timeout = deadline > now ? std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now)
+                                 : std::chrono::nanoseconds::zero();
+    }
+    const auto &options = driver.m_options;
+    switch (options.strategy)
+    {
+        case WaitStrategy::BusySpin:
+            CpuRelax();
+            break;
+        case WaitStrategy::SpinYield:
+            if (idleRounds < options.spinCount)
+            {
+                CpuRelax();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+            break;
+        case WaitStrategy::SpinPark:
+        {
+            // 距到期不足parkMarginUs时继续自旋,挂起只到到期前parkMarginUs处
+            auto margin = std::chrono::microseconds(options.parkMarginUs);
+            if (idleRounds < options.spinCount || timeout <= margin)
+            {
+                CpuRelax();
+                break;
+            }
+            // 先声明挂起再读取序号,与Notify中的"先递增序号再检查挂起"配对,保证不会丢失唤醒
+            driver.m_parked.store(true);
+            uint32_t seq = driver.m_wakeSeq.load();
+            bool pending = false;
+            for (std::size_t i = driver.m_firstLane; i < driver.m_lastLane && !pending; ++i)
+            {
+                std::lock_guard<std::mutex> lock(m_lanes[i].m_mutex_queue);
+                pending = !m_lanes[i].m_task_queue.empty();
+            }
+            if (!pending && driver.m_isRunning.load())
+            {
+                FutexWait(driver.m_wakeSeq, seq,
+                          timeout == std::chrono::nanoseconds::max() ? timeout : timeout - margin);
+            }
+            driver.m_parked.store(false);
+            break;
+        }
+        case WaitStrategy::Sleep:
+            std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(options.sleepMs)));
+            break;
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::Notify(Driver &driver)
+{
+    driver.m_wakeSeq.fetch_add(1);
+    if (driver.m_parked.load()) // 驱动线程未挂起时省去一次系统调用
+    {
+        FutexWakeAll(driver.m_wakeSeq);
+    }
+}
+
+template<class Clock>
+void BasicTimerManager<Clock>::Stop()
+{
+    m_driver.m_isRunning.store(false);
+    Notify(m_driver);
+    if (m_highDedicated.load())
+    {
+        m_highDriver.m_isRunning.store(false);
+        Notify(m_highDriver);
+        if (m_highThread.joinable())
+        {
+            m_highThread.join();
+        }
+        m_highDedicated.store(false);
+    }
+    if (m_watchdogRunning.exchange(false))
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_watchdogMutex); // 避免监控线程在检查条件后、等待前错过通知
+        }
+        m_watchdogCv.notify_all();
+        m_watchdogThread.join();
+    }
+}
+
+template<class Clock>
+BasicTimerManager<Clock>::~BasicTimerManager()
+{
+    Stop(); // 独立驱动线程或监控线程仍在运行时析构std::thread会直接terminate
+}
+
+// 默认时钟的实例化放在TimeLineTimer.cpp中,避免每个编译单元重复实例化
+extern template class BasicTimeLineTimer<FastSteadyClock>;
+extern template class BasicTimerManager<FastSteadyClock>;
+
+using TimerManager = BasicTimerManager<FastSteadyClock>;
+
 } // cxk
 
 #endif //STEADYTIMER_TIMELINETIMER_H
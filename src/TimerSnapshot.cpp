@@ -0,0 +1,145 @@
+//
+// Created by cxk_zjq on 25-6-8.
+//
+
+#include "TimerSnapshot.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <spdlog/spdlog.h>
+
+namespace cxk
+{
+
+std::int64_t WallClockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool WriteFileAtomically(const std::string &path, const void *data, std::size_t size)
+{
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        ReportSnapshotError("open", tmp);
+        return false;
+    }
+    const char *p = static_cast<const char *>(data);
+    std::size_t left = size;
+    while (left > 0) // 正常情况下一次write即可写完,被信号打断或短写时继续
+    {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            ReportSnapshotError("write", tmp);
+            ::close(fd);
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        p += n;
+        left -= static_cast<std::size_t>(n);
+    }
+    if (::fsync(fd) != 0)
+    {
+        ReportSnapshotError("fsync", tmp);
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    ::close(fd);
+    if (::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        ReportSnapshotError("rename", path);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        ::munmap(const_cast<char *>(m_data), m_size);
+    }
+}
+
+bool MappedFile::Open(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        ReportSnapshotError("open", path);
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ReportSnapshotError("stat", path);
+        ::close(fd);
+        return false;
+    }
+    int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+    flags |= MAP_POPULATE; // 一次性预读整个文件,避免逐页缺页
+#endif
+    void *addr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, flags, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        ReportSnapshotError("mmap", path);
+        ::close(fd);
+        return false;
+    }
+    ::close(fd); // 映射建立后即可关闭文件描述符
+    ::madvise(addr, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+    m_data = static_cast<const char *>(addr);
+    m_size = static_cast<std::size_t>(st.st_size);
+    return true;
+}
+
+bool ParseSnapshot(const MappedFile &file, const SnapshotHeader *&header, const SnapshotRecord *&records,
+                   const char *&payload)
+{
+    if (file.Size() < sizeof(SnapshotHeader))
+    {
+        return false;
+    }
+    header = reinterpret_cast<const SnapshotHeader *>(file.Data());
+    if (std::memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 ||
+        header->version != kSnapshotVersion || header->recordSize != sizeof(SnapshotRecord))
+    {
+        return false;
+    }
+    std::size_t body = file.Size() - sizeof(SnapshotHeader);
+    if (header->count > body / sizeof(SnapshotRecord) ||
+        header->payloadBytes != body - header->count * sizeof(SnapshotRecord))
+    {
+        return false;
+    }
+    records = reinterpret_cast<const SnapshotRecord *>(file.Data() + sizeof(SnapshotHeader));
+    payload = reinterpret_cast<const char *>(records + header->count);
+    return true;
+}
+
+void ReportSnapshotError(const char *what, const std::string &path)
+{
+    spdlog::error("timer snapshot: {} failed for {}: {}", what, path, std::strerror(errno));
+}
+
+void ReportSnapshotSkipped(std::size_t skipped, const std::string &path)
+{
+    spdlog::warn("timer snapshot: skipped {} records from {} (invalid or unregistered handler)", skipped, path);
+}
+
+} // cxk
@@ -0,0 +1,90 @@
+//
+// Created by cxk_zjq on 25-6-8.
+//
+
+#ifndef STEADYTIMER_TIMERSNAPSHOT_H
+#define STEADYTIMER_TIMERSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cxk
+{
+
+/**
+ * @brief 定时器快照文件格式
+ *
+ * [SnapshotHeader][SnapshotRecord * count][payload数据区]
+ * 所有字段按本机字节序保存,快照只用于同一台机器上的进程重启,不做跨平台兼容。
+ * 时间字段均为毫秒,deadline基于保存快照的进程的时钟,恢复时按savedClockMs换算为相对时间后重新定位。
+ */
+struct SnapshotHeader
+{
+    char magic[8];              // "STIMSNAP"
+    std::uint32_t version;      // 格式版本
+    std::uint32_t recordSize;   // sizeof(SnapshotRecord),用于校验
+    std::uint64_t count;        // 记录个数
+    std::uint64_t payloadBytes; // payload数据区长度
+    std::uint64_t savedClockMs; // 保存时定时器时钟的当前时间
+    std::int64_t savedWallMs;   // 保存时的系统时间(自epoch起),用于扣除停机时间
+};
+
+struct SnapshotRecord
+{
+    std::uint64_t deadline;      // 下一次触发时间
+    std::uint64_t interval;      // 间隔
+    std::uint64_t repeatCount;   // 剩余重复次数
+    std::uint64_t payloadOffset; // 在payload数据区中的偏移
+    std::uint32_t payloadSize;   // payload长度
+    std::uint32_t handlerId;     // 注册的处理函数id
+    std::uint32_t priority;      // TimerPriority
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 48, "unexpected SnapshotHeader layout");
+static_assert(sizeof(SnapshotRecord) == 48, "unexpected SnapshotRecord layout");
+
+constexpr char kSnapshotMagic[8] = {'S', 'T', 'I', 'M', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t kSnapshotVersion = 1;
+
+std::int64_t WallClockMs(); // 当前系统时间(ms)
+
+/**
+ * @brief 将data一次性写入path
+ * 先写入同目录下的临时文件并fsync,再rename覆盖目标文件,保证快照文件要么完整要么不存在
+ */
+bool WriteFileAtomically(const std::string &path, const void *data, std::size_t size);
+
+/**
+ * @brief 只读内存映射文件,析构时自动解除映射
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    bool Open(const std::string &path);
+    const char *Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+
+private:
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+/**
+ * @brief 校验快照文件的头部和记录区,成功时返回头部、记录和payload数据区的位置
+ */
+bool ParseSnapshot(const MappedFile &file, const SnapshotHeader *&header, const SnapshotRecord *&records,
+                   const char *&payload);
+
+void ReportSnapshotError(const char *what, const std::string &path); // 输出到spdlog,附带errno说明
+void ReportSnapshotSkipped(std::size_t skipped, const std::string &path); // 恢复时跳过了无效或未注册处理函数的记录
+
+} // cxk
+
+#endif //STEADYTIMER_TIMERSNAPSHOT_H
@@ -0,0 +1,111 @@
+//
+// Created by cxk_zjq on 25-6-3.
+//
+
+#include "WaitStrategy.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+#if defined(LIBGO_SYS_Linux)
+#include <pthread.h>
+#include <sched.h>
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cxk
+{
+
+const char *ToString(WaitStrategy strategy)
+{
+    switch (strategy)
+    {
+        case WaitStrategy::BusySpin: return "busy-spin";
+        case WaitStrategy::SpinYield: return "spin-yield";
+        case WaitStrategy::SpinPark: return "spin-park";
+        case WaitStrategy::Sleep: return "sleep";
+    }
+    return "unknown";
+}
+
+bool PinCurrentThread(int cpu)
+{
+    if (cpu < 0)
+    {
+        return false;
+    }
+#if defined(LIBGO_SYS_Linux)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool SetCurrentThreadName(const std::string &name)
+{
+    if (name.empty())
+    {
+        return false;
+    }
+#if defined(LIBGO_SYS_Linux)
+    // 内核限制线程名最长15个字符(不含结尾的'\0')，超出部分截断
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+#else
+    return false;
+#endif
+}
+
+void ApplyDriverThreadOptions(const DriverOptions &options)
+{
+    // 未配置的项不算失败,只报告显式要求但没生效的
+    if (options.cpu >= 0 && !PinCurrentThread(options.cpu))
+    {
+        spdlog::warn("timer driver: failed to pin thread to cpu {}", options.cpu);
+    }
+    if (!options.threadName.empty() && !SetCurrentThreadName(options.threadName))
+    {
+        spdlog::warn("timer driver: failed to set thread name {}", options.threadName);
+    }
+}
+
+void FutexWait(std::atomic<uint32_t> &word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+#if defined(LIBGO_SYS_Linux)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bits");
+    struct timespec ts{};
+    struct timespec *pts = nullptr;
+    if (timeout != std::chrono::nanoseconds::max())
+    {
+        auto ns = std::max<std::chrono::nanoseconds::rep>(0, timeout.count());
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        pts = &ts;
+    }
+    // 值已变化时内核立即返回EAGAIN，被信号打断返回EINTR，调用方都会重新检查状态
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, expected, pts, nullptr, 0);
+#else
+    if (word.load(std::memory_order_acquire) == expected)
+    {
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::milliseconds(1)));
+    }
+#endif
+}
+
+void FutexWakeAll(std::atomic<uint32_t> &word)
+{
+#if defined(LIBGO_SYS_Linux)
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    static_cast<void>(word);
+#endif
+}
+
+} // cxk
@@ -0,0 +1,75 @@
+//
+// Created by cxk_zjq on 25-6-3.
+//
+
+#ifndef STEADYTIMER_WAITSTRATEGY_H
+#define STEADYTIMER_WAITSTRATEGY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "clock.h"
+
+namespace cxk
+{
+
+/**
+ * @brief 驱动线程在两次Update之间的等待策略
+ *
+ * BusySpin  : 忙等 + pause 指令，延迟最低，独占一个核，适合隔离核上的关键定时器
+ * SpinYield : 先自旋 spinCount 次，之后每轮 yield 让出时间片
+ * SpinPark  : 先自旋 spinCount 次，之后通过 futex 挂起到下一个到期时间前 parkMarginUs 处或有新定时器加入，
+ *             剩余的时间继续自旋，抵消内核唤醒延迟
+ * Sleep     : 每轮休眠至多 sleepMs 毫秒，CPU 占用最低，适合共享机器
+ */
+enum class WaitStrategy
+{
+    BusySpin,
+    SpinYield,
+    SpinPark,
+    Sleep,
+};
+
+/**
+ * @brief 驱动线程配置，需在 TimerManager::Start() 之前设置
+ */
+struct DriverOptions
+{
+    WaitStrategy strategy = WaitStrategy::BusySpin; // 默认保持原来的热自旋行为
+    std::size_t spinCount = 1000;  // SpinYield/SpinPark 进入让出/挂起前的空转次数
+    std::size_t sleepMs = 1;       // Sleep 策略单次最长休眠时间(ms)
+    std::size_t parkMarginUs = 100; // SpinPark 提前醒来自旋的时间(us)，覆盖 futex 超时的唤醒延迟
+    int cpu = -1;                  // 驱动线程绑定的CPU核，-1表示不绑定
+    std::string threadName;        // 驱动线程名称，为空则不修改(Linux下最多15个字符)
+};
+
+const char *ToString(WaitStrategy strategy);
+
+/**
+ * @brief 自旋等待时的CPU提示，x86下为 pause 指令，降低功耗并避免退出自旋时的流水线惩罚
+ */
+ALWAYS_INLINE void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+bool PinCurrentThread(int cpu); // 将当前线程绑定到指定CPU核
+bool SetCurrentThreadName(const std::string &name); // 设置当前线程名称
+void ApplyDriverThreadOptions(const DriverOptions &options); // 按options绑核并设置线程名,失败时输出到spdlog
+
+/**
+ * @brief 在 word 的值仍等于 expected 时挂起当前线程，直到被唤醒或超时
+ * @param timeout 超时时间，精确到纳秒，避免按毫秒取整导致晚醒；nanoseconds::max() 表示无限等待
+ * @note 非Linux平台退化为休眠
+ */
+void FutexWait(std::atomic<uint32_t> &word, uint32_t expected, std::chrono::nanoseconds timeout);
+void FutexWakeAll(std::atomic<uint32_t> &word);
+
+} // cxk
+
+#endif //STEADYTIMER_WAITSTRATEGY_H
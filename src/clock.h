@@ -203,6 +203,48 @@ public:
 };
 #endif
 
+/**
+ * @brief 手动推进的虚拟时钟
+ *
+ * 接口与std::chrono时钟兼容,时间只在调用Advance/SetTime时变化,
+ * 用于确定性的定时器仿真和压力测试:逻辑时间可以瞬间推进,不需要等待真实时间流逝。
+ * 时间为进程内全局状态,所有使用VirtualClock的定时器共享同一时间轴。
+ */
+class VirtualClock
+{
+public:
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<VirtualClock> time_point;
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept {
+        return time_point(duration(self().load(std::memory_order_acquire)));
+    }
+
+    // 将时间向前推进d
+    template<class Rep, class Period>
+    static void Advance(std::chrono::duration<Rep, Period> d) noexcept {
+        self().fetch_add(std::chrono::duration_cast<duration>(d).count(), std::memory_order_acq_rel);
+    }
+
+    // 直接设置当前时间,调用方需保证时间不回退
+    static void SetTime(time_point tp) noexcept {
+        self().store(tp.time_since_epoch().count(), std::memory_order_release);
+    }
+
+    static void Reset() noexcept {
+        self().store(0, std::memory_order_release);
+    }
+
+private:
+    static std::atomic<rep>& self() {
+        static std::atomic<rep> instance{0};
+        return instance;
+    }
+};
+
 } // namespace co
 
 #endif //CLOCK_H
@@ -0,0 +1,56 @@
+//
+// Created by cxk_zjq on 25-6-8.
+//
+
+#ifndef STEADYTIMER_SIMTIMERFIXTURE_H
+#define STEADYTIMER_SIMTIMERFIXTURE_H
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include "TimeLineTimer.h"
+
+namespace cxk::test
+{
+
+using SimTimerManager = BasicTimerManager<VirtualClock>;
+
+// 使用VirtualClock的定时器用例共用的夹具:每个用例使用干净的时间轴和空的定时器管理器
+class SimTimerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        VirtualClock::Reset();
+        manager().Clear();
+    }
+
+    void TearDown() override {
+        manager().Clear();
+    }
+
+    static SimTimerManager& manager() {
+        return Singleton<SimTimerManager>::GetInstance();
+    }
+
+    static std::size_t Now() {
+        return SimTimerManager::Timer::GetCurrentTime();
+    }
+
+    static void SetMs(std::size_t ms) {
+        VirtualClock::SetTime(VirtualClock::time_point(std::chrono::milliseconds(ms)));
+    }
+
+    // 反复跳到下一个到期时间并触发,直到没有定时器或超过end(ms)
+    // 已过期但本轮未处理完的定时器(如受tick预算限制)其到期时间早于当前时间,时钟只前进不回退
+    static std::size_t RunUntil(std::size_t end) {
+        std::size_t fired = manager().Update();
+        while (manager().NextDeadline() != static_cast<std::size_t>(-1) && manager().NextDeadline() <= end) {
+            SetMs(std::max(Now(), manager().NextDeadline()));
+            fired += manager().Update();
+        }
+        return fired;
+    }
+};
+
+} // cxk::test
+
+#endif //STEADYTIMER_SIMTIMERFIXTURE_H
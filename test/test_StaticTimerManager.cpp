@@ -0,0 +1,202 @@
+//
+// Created by cxk_zjq on 25-6-6.
+//
+#include <gtest/gtest.h>
+#include "StaticTimerManager.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace cxk;
+
+namespace
+{
+
+struct CountCallback
+{
+    std::size_t *counter;
+    void operator()() { ++*counter; }
+};
+
+struct RecordCallback
+{
+    std::vector<std::size_t> *fires;
+    void operator()() {
+        fires->push_back(static_cast<std::size_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(VirtualClock::now().time_since_epoch()).count()));
+    }
+};
+
+using Geometry = WheelGeometry<64, 1>;
+using SimStaticTimerManager = BasicStaticTimerManager<VirtualClock, Geometry, CountCallback, RecordCallback>;
+
+void AdvanceMs(std::size_t ms)
+{
+    VirtualClock::Advance(std::chrono::milliseconds(ms));
+}
+
+} // namespace
+
+TEST(WheelGeometryTest, IndexMathIsConstexpr) {
+    static_assert(WheelGeometry<256, 4>::SlotOf(257) == 1, "slot index wraps by mask");
+    static_assert(WheelGeometry<256, 4>::ToTicks(0) == 1, "zero interval rounds up to one tick");
+    static_assert(WheelGeometry<256, 4>::ToTicks(9) == 3, "interval rounds up to whole ticks");
+    static_assert(WheelGeometry<256, 4>::ToTick(9) == 2, "time rounds down to tick");
+}
+
+// 两种回调类型各自按值保存并正确分派,重复次数准确
+TEST(StaticTimerManagerTest, DispatchAndRepeat) {
+    VirtualClock::Reset();
+    SimStaticTimerManager manager;
+    std::size_t counter = 0;
+    std::vector<std::size_t> fires;
+
+    manager.AddTimer(10, CountCallback{&counter}, 3);
+    manager.AddTimer(25, RecordCallback{&fires}, 4);
+    EXPECT_EQ(manager.Size(), 2u);
+
+    for (int i = 0; i < 200; ++i) {
+        manager.Update();
+        AdvanceMs(1);
+    }
+    EXPECT_EQ(counter, 3u);
+    EXPECT_EQ(fires, (std::vector<std::size_t>{0, 25, 50, 75}));
+    EXPECT_EQ(manager.Size(), 0u);
+}
+
+// 间隔超过时间轮一圈的定时器按正确的圈数触发
+TEST(StaticTimerManagerTest, IntervalLongerThanWheel) {
+    VirtualClock::Reset();
+    SimStaticTimerManager manager;
+    std::vector<std::size_t> fires;
+
+    manager.AddTimer(Geometry::kSlots * 3 + 5, RecordCallback{&fires}, 3);
+    for (std::size_t i = 0; i < Geometry::kSlots * 7; ++i) {
+        manager.Update();
+        AdvanceMs(1);
+    }
+    EXPECT_EQ(fires, (std::vector<std::size_t>{0, 197, 394}));
+}
+
+// 大量随机定时器逐tick推进,每个定时器触发次数和时间都准确
+TEST(StaticTimerManagerTest, RandomTimersMatchSchedule) {
+    VirtualClock::Reset();
+    SimStaticTimerManager manager;
+    constexpr std::size_t kTimers = 20000;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<std::size_t> intervalDist(1, 500);
+    std::uniform_int_distribution<std::size_t> repeatDist(1, 8);
+
+    std::vector<std::vector<std::size_t>> fires(kTimers);
+    std::vector<std::size_t> intervals(kTimers), repeats(kTimers);
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        intervals[i] = intervalDist(rng);
+        repeats[i] = repeatDist(rng);
+        manager.AddTimer(intervals[i], RecordCallback{&fires[i]}, repeats[i]);
+    }
+    for (std::size_t t = 0; t <= 500 * 8; ++t) {
+        manager.Update();
+        AdvanceMs(1);
+    }
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        ASSERT_EQ(fires[i].size(), repeats[i]);
+        for (std::size_t k = 0; k < repeats[i]; ++k) {
+            ASSERT_EQ(fires[i][k], k * intervals[i]);
+        }
+    }
+    EXPECT_EQ(manager.Size(), 0u);
+}
+
+// 时钟一次跳过多圈时,已到期的定时器都会触发,并按经过的周期补齐
+TEST(StaticTimerManagerTest, CatchUpAfterLargeJump) {
+    VirtualClock::Reset();
+    SimStaticTimerManager manager;
+    std::size_t counter = 0;
+
+    manager.AddTimer(100, CountCallback{&counter}, 5);
+    manager.Update();
+    EXPECT_EQ(counter, 1u);
+
+    AdvanceMs(Geometry::kSlots * 10);
+    manager.Update();
+    EXPECT_EQ(counter, 5u);
+    EXPECT_EQ(manager.Size(), 0u);
+}
+
+// 落后超过一整圈时,补齐的触发仍按到期顺序执行
+TEST(StaticTimerManagerTest, CatchUpFiresInDeadlineOrder) {
+    struct DeadlineCallback
+    {
+        std::vector<std::size_t> *deadlines;
+        std::size_t interval;
+        std::size_t fired;
+        void operator()() { deadlines->push_back(interval * fired++); } // 第k次触发的理论时间
+    };
+    VirtualClock::Reset();
+    BasicStaticTimerManager<VirtualClock, Geometry, DeadlineCallback> manager;
+    std::vector<std::size_t> deadlines;
+    for (std::size_t interval : {30, 70, 11, 5})
+    {
+        manager.AddTimer(interval, DeadlineCallback{&deadlines, interval, 0}, 12);
+    }
+    manager.Update();
+    EXPECT_EQ(deadlines.size(), 4u);
+
+    AdvanceMs(Geometry::kSlots * 20);
+    manager.Update();
+    EXPECT_EQ(deadlines.size(), 48u);
+    EXPECT_TRUE(std::is_sorted(deadlines.begin(), deadlines.end()));
+    EXPECT_EQ(manager.Size(), 0u);
+}
+
+// 回调抛出异常时异常从Update传出,时间轮保持完整:每个定时器仍然恰好触发repeat次
+TEST(StaticTimerManagerTest, ThrowingCallbackDoesNotRefire) {
+    struct MaybeThrow
+    {
+        std::size_t *counter;
+        bool throws;
+        void operator()() {
+            ++*counter;
+            if (throws) {
+                throw std::runtime_error("boom");
+            }
+        }
+    };
+    VirtualClock::Reset();
+    BasicStaticTimerManager<VirtualClock, Geometry, MaybeThrow> manager;
+    std::size_t a = 0, b = 0, c = 0;
+    manager.AddTimer(10, MaybeThrow{&a, false}, 3);
+    manager.AddTimer(10, MaybeThrow{&b, true}, 3);
+    manager.AddTimer(10, MaybeThrow{&c, false}, 3);
+    for (int i = 0; i < 100; ++i) {
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            try {
+                manager.Update();
+                break;
+            } catch (const std::runtime_error &) {
+            }
+        }
+        AdvanceMs(1);
+    }
+    EXPECT_EQ(a, 3u);
+    EXPECT_EQ(b, 3u);
+    EXPECT_EQ(c, 3u);
+    EXPECT_EQ(manager.Size(), 0u);
+}
+
+// 单一回调类型时variant只有一个候选,可直接使用lambda
+TEST(StaticTimerManagerTest, SingleLambdaType) {
+    VirtualClock::Reset();
+    std::size_t counter = 0;
+    auto callback = [&counter]() { ++counter; };
+    BasicStaticTimerManager<VirtualClock, WheelGeometry<16, 2>, decltype(callback)> manager;
+
+    manager.AddTimer(3, callback, 10); // 向上取整为2个tick,即4ms
+    for (int i = 0; i < 40; ++i) {
+        manager.Update();
+        AdvanceMs(1);
+    }
+    EXPECT_EQ(counter, 10u);
+}
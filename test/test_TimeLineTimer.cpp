@@ -6,6 +6,7 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 using namespace cxk;
 
@@ -146,6 +147,144 @@ TEST(TimeLineTimerTest, InfiniteRepeatTimer) {
     EXPECT_EQ(counter, 10);
 }
 
+// 测试挂起等待策略:新定时器加入和Stop都能唤醒挂起的驱动线程
+TEST(TimerManagerTest, SpinParkWakesOnAddAndStop) {
+    TimerManager& manager = cxk::Singleton<cxk::TimerManager>::GetInstance();
+    std::atomic<int> counter(0);
+    auto callback = [&counter]() { counter++; };
+
+    DriverOptions options;
+    options.strategy = WaitStrategy::SpinPark;
+    options.spinCount = 0;
+    options.threadName = "timer-park";
+    manager.SetDriverOptions(options);
+
+    std::thread managerThread([&]() {
+        manager.Start();
+    });
+
+    // 没有定时器时驱动线程会无限期挂起,等待AddTimer唤醒
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    manager.AddTimer(10, callback, 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(counter, 2);
+
+    manager.Stop();
+    managerThread.join();
+    manager.SetDriverOptions(DriverOptions{});
+}
+
+// 测试同一批到期的定时器按优先级执行
+TEST(TimerManagerTest, PriorityOrderWithinBatch) {
+    TimerManager& manager = cxk::Singleton<cxk::TimerManager>::GetInstance();
+    std::vector<int> order;
+
+    manager.AddTimer(1000, [&order]() { order.push_back(2); }, 1, TimerPriority::Low);
+    manager.AddTimer(1000, [&order]() { order.push_back(1); }, 1, TimerPriority::Normal);
+    manager.AddTimer(1000, [&order]() { order.push_back(0); }, 1, TimerPriority::High);
+    manager.AddTimer(1000, [&order]() { order.push_back(2); }, 1, TimerPriority::Low);
+
+    EXPECT_EQ(manager.Update(), 4u);
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 2}));
+}
+
+// 测试每轮预算:超出的Normal/Low回调顺延到下一轮,High不受限制
+TEST(TimerManagerTest, TickBudgetDefersLowPriority) {
+    TimerManager& manager = cxk::Singleton<cxk::TimerManager>::GetInstance();
+    std::atomic<int> low(0), high(0);
+
+    manager.SetTickBudget(2);
+    for (int i = 0; i < 5; ++i) {
+        manager.AddTimer(1000, [&low]() { low++; }, 1, TimerPriority::Low);
+    }
+    for (int i = 0; i < 3; ++i) {
+        manager.AddTimer(1000, [&high]() { high++; }, 1, TimerPriority::High);
+    }
+
+    EXPECT_EQ(manager.Update(), 5u);
+    EXPECT_EQ(high, 3);
+    EXPECT_EQ(low, 2);
+    EXPECT_EQ(manager.Update(), 2u);
+    EXPECT_EQ(manager.Update(), 1u);
+    EXPECT_EQ(low, 5);
+    manager.SetTickBudget(-1);
+}
+
+// 测试看门狗:回调耗时超出预算时触发告警
+TEST(TimerManagerTest, WatchdogFlagsSlowCallback) {
+    TimerManager& manager = cxk::Singleton<cxk::TimerManager>::GetInstance();
+    std::size_t flagged = 0;
+    TimerPriority flaggedPriority = TimerPriority::Normal;
+
+    manager.SetWatchdog(1000, [&](TimerPriority priority, std::size_t elapsedUs) {
+        flagged = elapsedUs;
+        flaggedPriority = priority;
+    });
+    manager.AddTimer(1000, []() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); }, 1, TimerPriority::Low);
+    manager.AddTimer(1000, []() {}, 1, TimerPriority::High);
+    manager.Update();
+    manager.SetWatchdog(-1);
+
+    EXPECT_GE(flagged, 5000u);
+    EXPECT_EQ(flaggedPriority, TimerPriority::Low);
+}
+
+// 测试看门狗:回调卡住时在返回之前由监控线程告警,且每次回调只告警一次
+TEST(TimerManagerTest, WatchdogFlagsHungCallback) {
+    TimerManager& manager = cxk::Singleton<cxk::TimerManager>::GetInstance();
+    std::atomic<int> reports(0);
+    std::atomic<bool> release(false), flaggedWhileRunning(false);
+
+    manager.SetWatchdog(2000, [&](TimerPriority, std::size_t elapsedUs) {
+        if (!release.load() && elapsedUs >= 2000) {
+            flaggedWhileRunning = true;
+        }
+        reports++;
+    });
+    std::thread managerThread([&]() {
+        manager.Start();
+    });
+    manager.AddTimer(1000, [&]() {
+        // 模拟卡住的回调:直到监控线程告警(最多1s)才返回
+        for (int i = 0; i < 1000 && !flaggedWhileRunning.load(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        release = true;
+    }, 1);
+    for (int i = 0; i < 2000 && !release.load(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    manager.Stop();
+    managerThread.join();
+    manager.SetWatchdog(-1);
+
+    EXPECT_TRUE(flaggedWhileRunning.load());
+    EXPECT_EQ(reports.load(), 1);
+}
+
+// 测试High通道的独立驱动线程
+TEST(TimerManagerTest, DedicatedHighPriorityDriver) {
+    TimerManager& manager = cxk::Singleton<cxk::TimerManager>::GetInstance();
+    std::atomic<int> high(0), normal(0);
+
+    DriverOptions options;
+    options.strategy = WaitStrategy::SpinPark;
+    options.spinCount = 100;
+    options.threadName = "timer-high";
+    manager.StartHighPriorityDriver(options);
+
+    manager.AddTimer(10, [&high]() { high++; }, 3, TimerPriority::High);
+    manager.AddTimer(10, [&normal]() { normal++; }, 1, TimerPriority::Normal);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(high, 3);
+    EXPECT_EQ(normal, 0); // 主驱动未启动
+
+    manager.Stop();
+    EXPECT_EQ(manager.Update(), 1u);
+    EXPECT_EQ(normal, 1);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
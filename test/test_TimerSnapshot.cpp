@@ -0,0 +1,173 @@
+//
+// Created by cxk_zjq on 25-6-8.
+//
+#include <gtest/gtest.h>
+#include "TimeLineTimer.h"
+#include "test/SimTimerFixture.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cxk;
+
+namespace
+{
+
+class TimerSnapshotTest : public test::SimTimerTest {
+protected:
+    void SetUp() override {
+        SimTimerTest::SetUp();
+        manager().RegisterHandler(1, [this](const std::string &payload) {
+            fires.emplace_back(Now(), payload);
+        });
+        path = ::testing::TempDir() + "steadytimer_snapshot.bin";
+    }
+
+    void TearDown() override {
+        SimTimerTest::TearDown();
+        std::remove(path.c_str());
+    }
+
+    std::vector<std::pair<std::size_t, std::string>> fires;
+    std::string path;
+};
+
+} // namespace
+
+// 剩余次数、间隔和payload都能恢复,deadline按保存时的剩余时间重新定位到新的时钟上
+TEST_F(TimerSnapshotTest, RoundTripRebasesDeadlines) {
+    SetMs(1000);
+    manager().AddPersistentTimer(100, 1, "lease", 3, TimerPriority::High);
+    manager().AddPersistentTimer(500, 1, "once", 1);
+    auto cancelled = manager().AddPersistentTimer(100, 1, "cancelled", 3);
+    manager().AddTimer(100, []() {}, 3); // 普通回调无法序列化
+    EXPECT_EQ(manager().AddPersistentTimer(100, 42, "unregistered"), 0u);
+    manager().Update();
+    manager().Cancel(cancelled);
+    EXPECT_EQ(fires.size(), 3u);
+
+    SetMs(1050);
+    std::size_t saved = 0;
+    ASSERT_TRUE(manager().Snapshot(path, &saved));
+    EXPECT_EQ(saved, 1u);
+
+    // 模拟新进程:时钟从另一个起点开始
+    manager().Clear();
+    fires.clear();
+    SetMs(7);
+    std::size_t restored = 0;
+    ASSERT_TRUE(manager().Restore(path, false, &restored));
+    EXPECT_EQ(restored, 1u);
+    EXPECT_EQ(manager().Size(), 1u);
+
+    for (std::size_t t = 7; t <= 400; ++t) {
+        SetMs(t);
+        manager().Update();
+    }
+    using Fire = std::pair<std::size_t, std::string>;
+    EXPECT_EQ(fires, (std::vector<Fire>{{57, "lease"}, {157, "lease"}}));
+    EXPECT_EQ(manager().Size(), 0u);
+}
+
+// 停机期间经过的系统时间计入已等待的时间,已过期的定时器恢复后立即触发
+TEST_F(TimerSnapshotTest, DowntimeIsElapsed) {
+    manager().AddPersistentTimer(20, 1, "retry", 2);
+    manager().Update();
+    fires.clear();
+    ASSERT_TRUE(manager().Snapshot(path));
+    manager().Clear();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    ASSERT_TRUE(manager().Restore(path));
+    EXPECT_EQ(manager().Update(), 1u);
+    ASSERT_EQ(fires.size(), 1u);
+    EXPECT_EQ(fires[0].second, "retry");
+}
+
+TEST_F(TimerSnapshotTest, RejectsMissingOrCorruptFile) {
+    EXPECT_FALSE(manager().Restore(path));
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "definitely not a timer snapshot, but long enough to hold a header";
+    }
+    EXPECT_FALSE(manager().Restore(path));
+    EXPECT_EQ(manager().Size(), 0u);
+}
+
+// 尚未合并的待添加定时器与已调度的定时器一起按deadline写出,每个通道内的记录有序
+TEST_F(TimerSnapshotTest, RecordsSortedWithinLane) {
+    manager().AddPersistentTimer(500, 1, "scheduled", 3);
+    manager().AddPersistentTimer(300, 1, "high", 3, TimerPriority::High);
+    manager().Update(); // 下一次到期分别为500和300
+    SetMs(100);
+    manager().AddPersistentTimer(100, 1, "queued", 3); // 仍在task_queue中,到期时间100
+    manager().AddPersistentTimer(50, 1, "queued-high", 3, TimerPriority::High);
+    ASSERT_TRUE(manager().Snapshot(path));
+
+    MappedFile file;
+    ASSERT_TRUE(file.Open(path));
+    const SnapshotHeader *header = nullptr;
+    const SnapshotRecord *records = nullptr;
+    const char *payload = nullptr;
+    ASSERT_TRUE(ParseSnapshot(file, header, records, payload));
+    ASSERT_EQ(header->count, 4u);
+    for (std::uint64_t i = 1; i < header->count; ++i) {
+        if (records[i].priority == records[i - 1].priority) {
+            EXPECT_LE(records[i - 1].deadline, records[i].deadline) << "record " << i;
+        }
+    }
+    EXPECT_EQ(std::string(payload + records[0].payloadOffset, records[0].payloadSize), "queued-high");
+    EXPECT_EQ(std::string(payload + records[2].payloadOffset, records[2].payloadSize), "queued");
+}
+
+// 大量定时器的快照与批量恢复
+TEST_F(TimerSnapshotTest, BulkRestoreAtScale) {
+    constexpr std::size_t kTimers = 200000;
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        manager().AddPersistentTimer(1 + i % 1000, 1, std::to_string(i), 2,
+                                     static_cast<TimerPriority>(i % kTimerPriorityCount));
+    }
+    manager().Update();
+    fires.clear();
+
+    std::size_t saved = 0, restored = 0;
+    ASSERT_TRUE(manager().Snapshot(path, &saved));
+    manager().Clear();
+    auto begin = std::chrono::steady_clock::now();
+    ASSERT_TRUE(manager().Restore(path, false, &restored));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    std::cout << "restored " << restored << " timers in " << elapsed.count() << "ms" << std::endl;
+    EXPECT_EQ(saved, kTimers);
+    EXPECT_EQ(restored, kTimers);
+
+    SetMs(1000);
+    EXPECT_EQ(manager().Update(), kTimers);
+    EXPECT_EQ(manager().Size(), 0u);
+}
+
+// 在定时器回调中保存快照不会死锁,正在执行的定时器按下一次到期时间写入
+TEST_F(TimerSnapshotTest, SnapshotFromCallback) {
+    std::size_t saved = 0, size = 0;
+    bool ok = false;
+    manager().AddPersistentTimer(100, 1, "lease", 5);
+    manager().AddTimer(1000, [&]() {
+        ok = manager().Snapshot(path, &saved);
+        size = manager().Size();
+    }, 2);
+    EXPECT_EQ(manager().Update(), 2u);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(saved, 1u);
+    EXPECT_EQ(size, 2u);
+
+    manager().Clear();
+    std::size_t restored = 0;
+    ASSERT_TRUE(manager().Restore(path, false, &restored));
+    EXPECT_EQ(restored, 1u);
+    fires.clear();
+    EXPECT_EQ(RunUntil(10000), 4u); // 快照时已触发一次,剩余4次
+    ASSERT_EQ(fires.size(), 4u);
+    EXPECT_EQ(fires.front().first, 100u);
+}
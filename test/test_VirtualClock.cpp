@@ -0,0 +1,237 @@
+//
+// Created by cxk_zjq on 25-6-5.
+//
+#include <gtest/gtest.h>
+#include "TimeLineTimer.h"
+#include "test/SimTimerFixture.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace cxk;
+using test::SimTimerManager;
+
+namespace
+{
+
+using VirtualClockTest = test::SimTimerTest;
+
+} // namespace
+
+TEST_F(VirtualClockTest, ClockAdvancesOnlyManually) {
+    auto t0 = VirtualClock::now();
+    EXPECT_EQ(VirtualClock::now(), t0);
+    VirtualClock::Advance(std::chrono::hours(3));
+    EXPECT_EQ(VirtualClock::now() - t0, std::chrono::hours(3));
+    EXPECT_EQ(Now(), 3u * 3600 * 1000);
+}
+
+// 定时器严格按到期时间触发,且没有任何延迟
+TEST_F(VirtualClockTest, FiresInDeadlineOrder) {
+    constexpr std::size_t kTimers = 100000;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::size_t> intervalDist(1, 3600 * 1000);
+
+    std::vector<std::size_t> fireTimes;
+    std::vector<std::size_t> expected(kTimers);
+    fireTimes.reserve(kTimers * 2);
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        std::size_t interval = intervalDist(rng);
+        expected[i] = interval;
+        manager().AddTimer(interval, [&fireTimes, &expected, i]() {
+            auto now = Now();
+            if (now > 0) { // 第一次在加入时立即触发,第二次在一个周期之后
+                EXPECT_EQ(now, expected[i]);
+            }
+            fireTimes.push_back(now);
+        }, 2);
+    }
+
+    EXPECT_EQ(RunUntil(static_cast<std::size_t>(-1)), kTimers * 2);
+    EXPECT_TRUE(std::is_sorted(fireTimes.begin(), fireTimes.end()));
+    EXPECT_EQ(manager().Size(), 0u);
+}
+
+// 大量不同重复次数的定时器在数小时逻辑时间内各自恰好触发repeat次
+TEST_F(VirtualClockTest, RepeatCountsAtScale) {
+    constexpr std::size_t kTimers = 100000;
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<std::size_t> intervalDist(1, 600 * 1000);
+    std::uniform_int_distribution<std::size_t> repeatDist(1, 20);
+
+    std::vector<std::size_t> counts(kTimers, 0), repeats(kTimers);
+    std::size_t total = 0, late = 0;
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        repeats[i] = repeatDist(rng);
+        total += repeats[i];
+        std::size_t interval = intervalDist(rng);
+        manager().AddTimer(interval, [&counts, &late, i, interval]() {
+            late += Now() != counts[i] * interval; // 第k次触发恰好在k个周期之后
+            counts[i]++;
+        }, repeats[i]);
+    }
+
+    EXPECT_EQ(RunUntil(static_cast<std::size_t>(-1)), total);
+    EXPECT_EQ(counts, repeats);
+    EXPECT_EQ(late, 0u);
+}
+
+// 取消:待添加队列中的、已触发过的、已结束的定时器都能正确处理
+TEST_F(VirtualClockTest, CancellationAtScale) {
+    constexpr std::size_t kTimers = 100000;
+    std::vector<std::size_t> counts(kTimers, 0);
+    std::vector<SimTimerManager::TimerId> ids(kTimers);
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        ids[i] = manager().AddTimer(100, [&counts, i]() { counts[i]++; }, 5,
+                                    static_cast<TimerPriority>(i % kTimerPriorityCount));
+    }
+
+    // 尚在队列中时取消一半,第一次触发就被丢弃
+    for (std::size_t i = 0; i < kTimers; i += 2) {
+        manager().Cancel(ids[i]);
+    }
+    manager().Update();
+
+    // 共触发三次之后再取消剩余的一半
+    RunUntil(200);
+    for (std::size_t i = 1; i < kTimers; i += 4) {
+        manager().Cancel(ids[i]);
+    }
+    RunUntil(static_cast<std::size_t>(-1));
+
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        std::size_t expect = i % 2 == 0 ? 0 : (i % 4 == 1 ? 3 : 5);
+        ASSERT_EQ(counts[i], expect) << "timer " << i;
+    }
+    EXPECT_EQ(manager().Size(), 0u);
+
+    // 取消已结束或无效的定时器不产生影响
+    manager().Cancel(ids[3]);
+    manager().Cancel(0);
+    EXPECT_EQ(manager().Update(), 0u);
+}
+
+// 每轮预算在虚拟时钟下同样生效
+TEST_F(VirtualClockTest, TickBudgetIsDeterministic) {
+    std::vector<int> order;
+    manager().SetTickBudget(3);
+    for (int i = 0; i < 10; ++i) {
+        manager().AddTimer(5, [&order, i]() { order.push_back(i); }, 1, TimerPriority::Low);
+    }
+    EXPECT_EQ(manager().Update(), 3u);
+    EXPECT_EQ(manager().Update(), 3u);
+    EXPECT_EQ(manager().Update(), 3u);
+    EXPECT_EQ(manager().Update(), 1u);
+    manager().SetTickBudget(-1);
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+// 突发到期时并行触发,同组定时器仍按到期顺序串行执行
+TEST_F(VirtualClockTest, BurstRunsInParallelAndKeepsGroupOrder) {
+    constexpr std::size_t kTimers = 10000;
+    constexpr std::size_t kGroups = 50;
+    constexpr std::size_t kRepeat = 3;
+    manager().SetBurstOptions(100, 3);
+
+    std::vector<std::vector<std::size_t>> groupOrder(kGroups + 1); // 每组只会在一个线程上执行,无需加锁
+    std::atomic<std::size_t> ungrouped{0};
+    std::mutex threadsMutex;
+    std::set<std::thread::id> threads;
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        std::size_t group = i % (kGroups + 1); // 0表示不约束顺序
+        manager().AddTimer(10, [&, i, group]() {
+            if (group == 0) {
+                ungrouped.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                groupOrder[group].push_back(Now() * kTimers + i);
+            }
+            std::lock_guard<std::mutex> lock(threadsMutex);
+            threads.insert(std::this_thread::get_id());
+        }, kRepeat, TimerPriority::Normal, group);
+    }
+    EXPECT_EQ(RunUntil(static_cast<std::size_t>(-1)), kTimers * kRepeat);
+    manager().SetBurstOptions(-1, 0);
+
+    std::size_t grouped = 0;
+    for (std::size_t g = 1; g <= kGroups; ++g) {
+        grouped += groupOrder[g].size();
+        EXPECT_TRUE(std::is_sorted(groupOrder[g].begin(), groupOrder[g].end())) << "group " << g;
+    }
+    EXPECT_EQ(grouped + ungrouped.load(), kTimers * kRepeat);
+    EXPECT_GT(threads.size(), 1u);
+}
+
+// 通道中一直有常驻定时器时,取消已结束或无效的定时器也不会留下取消记录
+TEST_F(VirtualClockTest, CancelFinishedTimerKeepsCancelledSetBounded) {
+    std::size_t ticks = 0;
+    manager().AddTimer(10, [&ticks]() { ++ticks; }); // repeat=-1的常驻定时器
+    for (std::size_t round = 0; round < 1000; ++round) {
+        auto id = manager().AddTimer(1, []() {}, 1);
+        RunUntil(Now() + 10);
+        manager().Cancel(id); // 已经触发完毕
+        manager().Cancel(id << 3); // 从未存在过的id
+        VirtualClock::Advance(std::chrono::milliseconds(1));
+        manager().Update();
+        ASSERT_EQ(manager().CancelledSize(), 0u) << "round " << round;
+    }
+    EXPECT_EQ(manager().Size(), 1u);
+    EXPECT_GT(ticks, 0u);
+
+    // 存活的定时器被取消后,在到期时丢弃并清除记录
+    std::size_t fired = 0;
+    auto id = manager().AddTimer(50, [&fired]() { ++fired; }, 3);
+    manager().Update();
+    manager().Cancel(id);
+    VirtualClock::Advance(std::chrono::milliseconds(1));
+    manager().Update();
+    EXPECT_EQ(manager().CancelledSize(), 1u);
+    RunUntil(Now() + 100);
+    EXPECT_EQ(manager().CancelledSize(), 0u);
+    EXPECT_EQ(fired, 1u);
+}
+
+// 回调抛出异常时异常从Update传出,已触发的定时器不会重复触发,未执行的顺延到下一轮
+TEST_F(VirtualClockTest, ThrowingCallbackDoesNotRefire) {
+    std::vector<int> counts(3, 0);
+    manager().AddTimer(100, [&counts]() { counts[0]++; }, 1);
+    manager().AddTimer(100, [&counts]() { counts[1]++; throw std::runtime_error("boom"); }, 1);
+    manager().AddTimer(100, [&counts]() { counts[2]++; }, 1);
+    EXPECT_THROW(manager().Update(), std::runtime_error);
+    EXPECT_EQ(counts, (std::vector<int>{1, 1, 0}));
+    EXPECT_EQ(manager().Update(), 1u);
+    EXPECT_EQ(counts, (std::vector<int>{1, 1, 1}));
+    EXPECT_EQ(manager().Size(), 0u);
+}
+
+// 并行触发时任一worker抛出异常,等全部worker结束后再从Update传出
+TEST_F(VirtualClockTest, ThrowingCallbackInBurst) {
+    constexpr std::size_t kTimers = 2000;
+    manager().SetBurstOptions(10, 3);
+    std::vector<std::atomic<int>> counts(kTimers);
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        manager().AddTimer(100, [&counts, i]() {
+            counts[i]++;
+            if (i % 500 == 7) {
+                throw std::runtime_error("boom");
+            }
+        }, 1, TimerPriority::Normal, i % 3 == 0 ? i % 40 : 0);
+    }
+    std::size_t fired = 0;
+    for (int round = 0; round < 10 && manager().Size() > 0; ++round) {
+        try {
+            fired += manager().Update();
+        } catch (const std::runtime_error &) {
+        }
+    }
+    manager().SetBurstOptions(-1, 0);
+    EXPECT_EQ(manager().Size(), 0u);
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        ASSERT_EQ(counts[i].load(), 1) << "timer " << i;
+    }
+}